@@ -111,6 +111,11 @@ void CALLBACK GSreset();
 void CALLBACK GSwriteCSR(u32 value);
 s32 CALLBACK GSfreeze(int mode, freezeData *data);
 
+// records everything sent to the GS into a dump file, for replaying without the emulator
+s32 CALLBACK GSdumpBegin(const char *filename);
+void CALLBACK GSdumpEnd();
+void CALLBACK GSsetCacheDir(const char *dir);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
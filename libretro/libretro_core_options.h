@@ -42,6 +42,16 @@ struct retro_core_option_definition option_defs[] = {
 	},
 	"disabled"},
 
+	{BOOL_PCSX2_OPT_IPU_THREAD,
+	"System: Threaded IPU Decoding",
+	"Decodes the next FMV macroblock on a separate thread while the previous one is transferred out of the IPU. Timing seen by the game is unchanged. May help FMVs on slow CPUs with a spare core.",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled"},
+
 	{BOOL_PCSX2_OPT_FASTBOOT,
 	"System: Fast Boot",
 	"Bypass the initial BIOS logo. (Content restart required)",
@@ -62,6 +72,16 @@ struct retro_core_option_definition option_defs[] = {
 	},
 	"disabled"},
 
+	{BOOL_PCSX2_OPT_DELTA_SAVESTATES,
+	"System: Run-Ahead Savestates",
+	"Only save the parts of main memory written since the previous savestate, which makes single-instance run-ahead much cheaper. States can then only be loaded right after they are saved: rewind, netplay, second-instance run-ahead and savestate files will not work. (Content restart required)",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled"},
+
 	{STRING_PCSX2_OPT_MEMCARD_SLOT_1,
 	"Memory Card: Slot 1",
 	"Select the primary memory card to use. 'Legacy' points to the memory card Mcd001 in the old location system/pcsx2/memcards. (Content restart required)",
@@ -88,6 +108,7 @@ struct retro_core_option_definition option_defs[] = {
 		{"D3D11", NULL},
 #endif
 		{"OpenGl", NULL},
+		{"CPU", "Software (no GPU)"},
 		{NULL, NULL},
 	},
 	"Auto"},
@@ -292,6 +313,36 @@ struct retro_core_option_definition option_defs[] = {
 	},
 	"1" },
 
+	{BOOL_PCSX2_OPT_GS_DUMP,
+	"Video: Record GS Dump",
+	"Records everything sent to the GS into a gsdump_*.gs file in the pcsx2 save folder while enabled, for replaying with the GSReplay tool. Files grow quickly.",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{BOOL_PCSX2_OPT_GUEST_PROFILER,
+	"System: Profile Guest Code",
+	"Samples the EE, IOP and VU1 program counters 1000 times per second while enabled. Disabling it, or closing the game, writes a per-function profile_*.txt in flamegraph.pl collapsed format into the pcsx2 save folder.",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{BOOL_PCSX2_OPT_EE_PROFILER,
+	"System: Profile EE Recompiler",
+	"Counts how often each recompiled EE block runs and how its memory accesses resolve while enabled. Switching it recompiles the EE code. Disabling it, or closing the game, prints the hottest blocks and per-opcode memory access counts to the log.",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
 	{BOOL_PCSX2_OPT_GAMEPAD_RUMBLE_ENABLE,
 	"Gamepad: Enable Rumble",
 	"Enables rumble on gamepads that support it",
@@ -9,6 +9,7 @@
 #include "AppCommon.h"
 #include "App.h"
 
+#include <chrono>
 #include <cstdint>
 #include <libretro.h>
 #include <libretro_core_options.h>
@@ -20,6 +21,7 @@
 #include <wx/evtloop.h>
 
 #include "GS.h"
+#include "SaveState.h"
 #include "options_tools.h"
 #include "retro_messager.h"
 #include "language_injector.h"
@@ -33,6 +35,9 @@
 
 
 #include "MTVU.h"
+#include "IPU/IPUthread.h"
+#include "DebugTools/GuestProfiler.h"
+#include "x86/R5900_Profiler.h"
 
 #ifdef PERF_TEST
 static struct retro_perf_callback perf_cb;
@@ -59,6 +64,7 @@ int option_upscale_mult = 1;
 std::string sel_bios_path = "";
 retro_environment_t environ_cb;
 retro_video_refresh_t video_cb;
+static retro_audio_sample_batch_t batch_cb;
 struct retro_hw_render_callback hw_render;
 unsigned libretro_msg_interface_version = 0;
 retro_log_printf_t log_cb;
@@ -87,6 +93,55 @@ static std::vector<std::string> bios_files;
 static std::vector<std::string> custom_memcard_list_slot1;
 static std::vector<std::string> custom_memcard_list_slot2;
 
+// The size of a state varies slightly (pending GIF path data), so the size reported to
+// the frontend is measured once per content and padded.
+static const size_t state_size_slack = _1mb;
+static size_t state_size = 0;
+
+// Delta states (see memDeltaSavingState) leave EE main memory out of the serialized state,
+// which only works for single-instance run-ahead.  Chosen once per content.
+static bool delta_states = false;
+
+// Snapshot cost report, logged every few seconds worth of frames while the frontend is
+// serializing every frame (rewind, run-ahead).
+struct SnapshotStats
+{
+	static const uint ReportInterval = 600;
+
+	uint count;
+	u64 total_us;
+	u64 max_us;
+	u64 dirty_pages;
+
+	void Reset() { memzero(*this); }
+	void Add(u64 us, uint pages)
+	{
+		++count;
+		total_us += us;
+		max_us = std::max(max_us, us);
+		dirty_pages += pages;
+
+		if (count < ReportInterval)
+			return;
+
+		log_cb(RETRO_LOG_INFO, "Savestate: %s snapshot cost %.3f ms avg, %.3f ms max per frame (%u dirty pages avg)\n",
+			delta_states ? "delta" : "full", total_us / 1000.0 / count, max_us / 1000.0, (uint)(dirty_pages / count));
+		Reset();
+	}
+};
+static SnapshotStats snapshot_stats;
+
+// GS dump recording, toggled from the core options.
+static bool gs_dump_active = false;
+
+// Guest profiler, toggled from the core options. The profile is written
+// when it gets disabled or when the game is unloaded.
+static void GuestProfilerDump()
+{
+	wxFileName profile_file(save_dir_root.GetPath(), wxDateTime::Now().Format("profile_%Y%m%d_%H%M%S"), "txt");
+	GuestProfiler::Dump((const char*)profile_file.GetFullPath());
+}
+
 void retro_set_video_refresh(retro_video_refresh_t cb)
 {
 	video_cb = cb;
@@ -137,6 +192,8 @@ void retro_init(void)
 	if (! save_dir_root.DirExists()) save_dir_root.Mkdir();
 	if (!slot1_file.DirExists()) slot1_file.Mkdir();
 	if (!slot2_file.DirExists()) slot2_file.Mkdir();
+
+	GSsetCacheDir((const char*)save_dir_root.GetPath());
 	
 
 	// check if legacy memcards exists
@@ -343,6 +400,7 @@ void retro_init(void)
 		g_Conf->EnablePresets = true;
 		g_Conf->EmuOptions.EnableIPC = false;
 		g_Conf->EmuOptions.Speedhacks.fastCDVD  = option_value(BOOL_PCSX2_OPT_FASTCDVD, KeyOptionBool::return_type);
+		ipuThreadSetEnabled(option_value(BOOL_PCSX2_OPT_IPU_THREAD, KeyOptionBool::return_type));
 
 		g_Conf->EmuOptions.EnableNointerlacingPatches = (option_value(INT_PCSX2_OPT_DEINTERLACING_MODE, KeyOptionInt::return_type) == -1);
 		g_Conf->EmuOptions.Enable60fpsPatches = (option_value(BOOL_PCSX2_OPT_ENABLE_60FPS_PATCHES, KeyOptionBool::return_type));
@@ -395,6 +453,7 @@ void retro_deinit(void)
 	and it gets stuck waiting for a mutex that will never unlock */
 	vu1Thread.WaitVU();
 	//vu1Thread.Cancel();
+	ipuThreadShutdown();
 
 	pcsx2->CleanupOnExit();
 	pcsx2->OnExit();
@@ -428,7 +487,8 @@ void retro_get_system_info(retro_system_info* info)
 
 void retro_get_system_av_info(retro_system_av_info* info)
 {
-	if ( !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software") || !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Null"))
+	if ( !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software") || !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Null")
+		|| !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "CPU"))
 	{
 		info->geometry.base_width = 640;
 		info->geometry.base_height = 448;
@@ -442,6 +502,13 @@ void retro_get_system_av_info(retro_system_av_info* info)
 	info->geometry.max_width = info->geometry.base_width;
 	info->geometry.max_height = info->geometry.base_height;
 
+	// Frames from the CPU renderer go out at the size the GS displays, which can exceed the base size
+	if (!std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "CPU"))
+	{
+		info->geometry.max_width = 1280;
+		info->geometry.max_height = 1024;
+	}
+
 	if (option_value(INT_PCSX2_OPT_ASPECT_RATIO, KeyOptionInt::return_type) == 0)
 		info->geometry.aspect_ratio = 4.0f / 3.0f;
 	else
@@ -583,6 +650,10 @@ bool retro_load_game(const struct retro_game_info* game)
 	}
 
 	ResetContentStuffs();
+	state_size = 0;
+	snapshot_stats.Reset();
+	delta_states = option_value(BOOL_PCSX2_OPT_DELTA_SAVESTATES, KeyOptionBool::return_type);
+	DeltaState_Enable(delta_states);
 
 	const char* selected_bios = option_value(STRING_PCSX2_OPT_BIOS, KeyOptionString::return_type);
 	if (selected_bios == NULL)
@@ -780,6 +851,14 @@ bool retro_load_game(const struct retro_game_info* game)
 #endif
 	else if (!std::strcmp(option_renderer, "Null"))
 		context_type = RETRO_HW_CONTEXT_NONE;
+	else if (!std::strcmp(option_renderer, "CPU"))
+	{
+		// The software renderer presents from system memory, so no hw context is requested
+		// and the GS is opened right away instead of from context_reset.
+		hw_render.context_type = RETRO_HW_CONTEXT_NONE;
+		context_reset();
+		return true;
+	}
 
 	return set_hw_render(context_type);
 }
@@ -792,6 +871,23 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info* i
 
 void retro_unload_game(void)
 {
+	state_size = 0;
+	DeltaState_Enable(false);
+
+	if (gs_dump_active)
+	{
+		GSdumpEnd();
+		gs_dump_active = false;
+	}
+
+	if (GuestProfiler::IsRunning())
+	{
+		GuestProfiler::Stop();
+		GuestProfilerDump();
+	}
+
+	EE::Profiler.SetEnabled(false);
+
 	//	GetMTGS().FinishTaskInThread();
 	//		GetMTGS().CloseGS();
 	GetMTGS().FinishTaskInThread();
@@ -820,7 +916,31 @@ void retro_run(void)
 			option_value(BOOL_PCSX2_OPT_GAMEPAD_RUMBLE_ENABLE, KeyOptionBool::return_type),
 			option_value(INT_PCSX2_OPT_GAMEPAD_RUMBLE_FORCE, KeyOptionInt::return_type)
 		);
+		ipuThreadSetEnabled(option_value(BOOL_PCSX2_OPT_IPU_THREAD, KeyOptionBool::return_type));
+
+		// The GS only runs inside ExecuteTaskInThread on this thread, so it's idle here.
+		bool gs_dump = option_value(BOOL_PCSX2_OPT_GS_DUMP, KeyOptionBool::return_type);
+		if (gs_dump && !gs_dump_active)
+		{
+			wxFileName dump_file(save_dir_root.GetPath(), wxDateTime::Now().Format("gsdump_%Y%m%d_%H%M%S"), "gs");
+			gs_dump_active = GSdumpBegin((const char*)dump_file.GetFullPath()) == 0;
+		}
+		else if (!gs_dump && gs_dump_active)
+		{
+			GSdumpEnd();
+			gs_dump_active = false;
+		}
 
+		bool profile = option_value(BOOL_PCSX2_OPT_GUEST_PROFILER, KeyOptionBool::return_type);
+		if (profile && !GuestProfiler::IsRunning())
+			GuestProfiler::Start(1000);
+		else if (!profile && GuestProfiler::IsRunning())
+		{
+			GuestProfiler::Stop();
+			GuestProfilerDump();
+		}
+
+		EE::Profiler.SetEnabled(option_value(BOOL_PCSX2_OPT_EE_PROFILER, KeyOptionBool::return_type));
 	}
 
 	Input::Update();
@@ -829,22 +949,134 @@ void retro_run(void)
 	RETRO_PERFORMANCE_START(pcsx2_run);
 
 	GetMTGS().ExecuteTaskInThread();
+	SndBuffer::Flush(batch_cb);
 
 	RETRO_PERFORMANCE_STOP(pcsx2_run);
 }
 
+// Parks the EE thread so that the VM can be frozen.  The EE only honours a pause request
+// at its next vsync and may be stalled on the GS ring on the way there, so the request is
+// posted without blocking and this thread (which is the MTGS) keeps draining the ring
+// until the pause has landed.
+static void cpu_thread_pause()
+{
+	GetCoreThread().Pause(false);
+	while (!GetCoreThread().IsPaused())
+	{
+		GetMTGS().DrainRingInThread();
+		std::this_thread::yield();
+	}
+
+	// Bring the GS up to the point where the EE stopped.
+	GetMTGS().DrainRingInThread();
+}
+
+// A state starts with the savestate version and its own length, so that a state from
+// another build or a truncated one is refused before anything in the VM is touched.
+struct state_header
+{
+	u32 version;
+	u32 length;
+};
+
+static void freeze_vm(SaveStateBase& state)
+{
+	state_header header = { g_SaveVersion, 0 };
+	state.Freeze(header);
+	state.FreezeAll();
+}
+
 size_t retro_serialize_size(void)
 {
-	return 0;
+	if (!GetCoreThread().HasActiveMachine())
+		return 0;
+
+	if (!state_size)
+	{
+		cpu_thread_pause();
+		memDeltaSavingState deltasizer(nullptr, 0);
+		memFixedSavingState fullsizer(nullptr, 0);
+		memFixedSavingState& sizer = delta_states ? deltasizer : fullsizer;
+		freeze_vm(sizer);
+		GetCoreThread().Resume();
+
+		state_size = sizer.GetCurrentPos() + state_size_slack;
+	}
+
+	return state_size;
 }
 
 bool retro_serialize(void* data, size_t size)
 {
-	return false;
+	if (!GetCoreThread().HasActiveMachine())
+		return false;
+
+	cpu_thread_pause();
+
+	auto start = std::chrono::steady_clock::now();
+	memDeltaSavingState deltame(data, size);
+	memFixedSavingState fullme(data, size);
+	memFixedSavingState& saveme = delta_states ? deltame : fullme;
+	freeze_vm(saveme);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	GetCoreThread().Resume();
+
+	if (saveme.IsOverflowed())
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate does not fit in %u bytes\n", (unsigned)size);
+		return false;
+	}
+
+	((state_header*)data)->length = saveme.GetCurrentPos();
+
+	// Keep the padding deterministic, netplay compares states byte for byte.
+	memset((u8*)data + saveme.GetCurrentPos(), 0, size - saveme.GetCurrentPos());
+
+	snapshot_stats.Add(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+		delta_states ? deltame.GetDirtyPageCount() : Ps2MemSize::MainRam >> 12);
+	return true;
 }
+
 bool retro_unserialize(const void* data, size_t size)
 {
-	return false;
+	if (!GetCoreThread().HasActiveMachine() || size < sizeof(state_header))
+		return false;
+
+	const state_header& header = *(const state_header*)data;
+	if (header.version != g_SaveVersion)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate version mismatch (state 0x%08x, core 0x%08x)\n", header.version, g_SaveVersion);
+		return false;
+	}
+
+	if (header.length < sizeof(state_header) || header.length > size)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate is truncated or invalid (%u bytes, header says %u)\n", (unsigned)size, header.length);
+		return false;
+	}
+
+	cpu_thread_pause();
+	memDeltaLoadingState deltame(data, header.length);
+	memFixedLoadingState fullme(data, header.length);
+	memFixedLoadingState& loadme = delta_states ? deltame : fullme;
+	freeze_vm(loadme);
+	GetCoreThread().Resume();
+
+	if (delta_states && deltame.IsStale())
+	{
+		log_cb(RETRO_LOG_ERROR, "Delta savestate is not the most recent one, it can't be loaded\n");
+		return false;
+	}
+
+	// The length was checked up front, so this means the state itself is malformed.
+	if (loadme.IsOverflowed() || loadme.GetCurrentPos() != header.length)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate is malformed\n");
+		return false;
+	}
+
+	return true;
 }
 
 unsigned retro_get_region(void)
@@ -879,6 +1111,7 @@ retro_audio_sample_t sample_cb;
 
 void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb)
 {
+	batch_cb = cb;
 }
 
 void retro_set_audio_sample(retro_audio_sample_t cb)
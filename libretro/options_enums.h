@@ -3,6 +3,7 @@
 
 #define BOOL_PCSX2_OPT_FASTCDVD			 "pcsx2_fastcdvd"
 #define BOOL_PCSX2_OPT_FASTBOOT			 "pcsx2_fastboot"
+#define BOOL_PCSX2_OPT_IPU_THREAD		 "pcsx2_ipu_thread"
 #define BOOL_PCSX2_OPT_ENABLE_WIDESCREEN_PATCHES "pcsx2_enable_widescreen_patches"
 #define BOOL_PCSX2_OPT_ENABLE_60FPS_PATCHES      "pcsx2_enable_60fps_patches"
 #define BOOL_PCSX2_OPT_FRAMESKIP		 "pcsx2_frameskip"
@@ -15,6 +16,10 @@
 #define BOOL_PCSX2_OPT_USERHACK_AUTO_FLUSH	 "pcsx2_userhack_auto_flush"
 #define BOOL_PCSX2_OPT_CONSERVATIVE_BUFFER	 "pcsx2_conservative_buffer"
 #define BOOL_PCSX2_OPT_ACCURATE_DATE		 "pcsx2_accurate_date"
+#define BOOL_PCSX2_OPT_DELTA_SAVESTATES		 "pcsx2_delta_savestates"
+#define BOOL_PCSX2_OPT_GS_DUMP			 "pcsx2_gs_dump"
+#define BOOL_PCSX2_OPT_GUEST_PROFILER		 "pcsx2_guest_profiler"
+#define BOOL_PCSX2_OPT_EE_PROFILER		 "pcsx2_ee_profiler"
 
 #define STRING_PCSX2_OPT_BIOS			 "pcsx2_bios"
 #define STRING_PCSX2_OPT_RENDERER                "pcsx2_renderer"
@@ -94,58 +94,71 @@ bool ChdFileReader::Open(const wxString &fileName)
     // const chd_header *header = chd_get_header(ChdFile);
     sector_size = header->unitbytes;
     sector_count = header->unitcount;
-    sectors_per_hunk = header->hunkbytes / sector_size;
-    hunk_buffer = new u8[header->hunkbytes];
-    current_hunk = -1;
+    hunk_bytes = header->hunkbytes;
+    hunk_count = header->totalhunks;
 
     delete header;
+
+    // libchdr's chd_file can't be shared between threads, so a single worker decodes.
+    readahead.Start(hunk_bytes, (u64)sector_count * sector_size, [this](u32 hunk, u8 *dest, uint worker) { return ReadHunk(hunk, dest); }, 1);
     return true;
 }
 
+// Called on the readahead thread only.
+int ChdFileReader::ReadHunk(u32 hunk, u8 *dest)
+{
+    if (hunk >= hunk_count)
+      return 0;
+
+    chd_error error = chd_read(ChdFile, hunk, dest);
+    if (error != CHDERR_NONE) {
+        log_cb(RETRO_LOG_ERROR, "chd_read return error: %s\n", chd_error_string(error));
+    }
+    return hunk_bytes;
+}
+
 int ChdFileReader::ReadSync(void *pBuffer, uint sector, uint count)
 {
     u8 *dst = (u8 *) pBuffer;
-    u32 hunk = sector / sectors_per_hunk;
-    u32 sector_in_hunk = sector % sectors_per_hunk;
-    chd_error error;
 
+    // Sectors never straddle hunks, so each one is a single copy from the cache.
     for (uint i = 0; i < count; i++) {
-      if (current_hunk != hunk) {
-        error = chd_read(ChdFile, hunk, hunk_buffer);
-        if (error != CHDERR_NONE) {
-            log_cb(RETRO_LOG_ERROR, "chd_read return error: %s\n", chd_error_string(error));
-            // return i * m_blocksize;
-        }
-        current_hunk = hunk;
-      }
-      memcpy(dst + i * m_blocksize, hunk_buffer + sector_in_hunk * sector_size, m_blocksize);
-      sector_in_hunk++;
-      if (sector_in_hunk >= sectors_per_hunk) {
-        hunk++;
-        sector_in_hunk = 0;
-      }
+      int res = readahead.Read(dst + i * m_blocksize, (u64)(sector + i) * sector_size, m_blocksize);
+      if (res < (int)m_blocksize)
+        return i * m_blocksize;
     }
     return m_blocksize * count;
 }
 
 void ChdFileReader::BeginRead(void *pBuffer, uint sector, uint count)
 {
-  // TODO: Check if libchdr can read asynchronously
-  async_read = ReadSync(pBuffer, sector, count);
+  pending_buffer = pBuffer;
+  pending_sector = sector;
+  pending_count = count;
+
+  // Get the worker going, the data is copied out in FinishRead().
+  readahead.Prefetch((u64)sector * sector_size, count * sector_size);
 }
 
 int ChdFileReader::FinishRead()
 {
-	return async_read;
+  if (pending_buffer == NULL)
+    return -1;
+
+  int res = ReadSync(pending_buffer, pending_sector, pending_count);
+  pending_buffer = NULL;
+  return res;
+}
+
+void ChdFileReader::CancelRead()
+{
+  pending_buffer = NULL;
 }
 
 void ChdFileReader::Close()
 {
-    if (hunk_buffer != NULL) {
-      //free(hunk_buffer);
-      delete[] hunk_buffer;
-      hunk_buffer = NULL;
-    }
+    // The worker reads from the chd, stop it first.
+    readahead.Stop();
     if (ChdFile != NULL) {
       chd_close(ChdFile);
       ChdFile = NULL;
@@ -169,5 +182,5 @@ u32 ChdFileReader::GetBlockCount() const
 ChdFileReader::ChdFileReader(void)
 {
   ChdFile = NULL;
-  hunk_buffer = NULL;
+  pending_buffer = NULL;
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "AsyncFileReader.h"
+#include "ReadaheadCache.h"
 #include "libchdr/chd.h"
 
 class ChdFileReader : public AsyncFileReader
@@ -15,7 +16,7 @@ public:
 
     void BeginRead(void *pBuffer, uint sector, uint count) override;
     int FinishRead(void) override;
-    void CancelRead(void) override {};
+    void CancelRead(void) override;
 
     void Close(void) override;
     void SetBlockSize(uint blocksize);
@@ -24,11 +25,19 @@ public:
     ChdFileReader(void);
 
 private:
+    int ReadHunk(u32 hunk, u8 *dest);
+
     chd_file *ChdFile;
-    u8 *hunk_buffer;
     u32 sector_size;
     u32 sector_count;
-    u32 sectors_per_hunk;
-    u32 current_hunk;
-    u32 async_read;
+    u32 hunk_bytes;
+    u32 hunk_count;
+
+    // Hunks are decompressed on a worker thread, ahead of sequential reads.
+    ReadaheadCache readahead;
+
+    // The request is stored here between BeginRead() and FinishRead().
+    void *pending_buffer;
+    uint pending_sector;
+    uint pending_count;
 };
\ No newline at end of file
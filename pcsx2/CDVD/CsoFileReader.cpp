@@ -102,6 +102,9 @@ bool CsoFileReader::Open(const wxString& fileName)
 		Close();
 		return false;
 	}
+
+	m_cache.Start(m_frameSize, m_totalSize, [this](u32 frame, u8* dest, uint worker) { return DecodeFrame(frame, dest, worker); },
+		(uint)m_decoders.size());
 	return true;
 }
 
@@ -142,20 +145,6 @@ bool CsoFileReader::InitializeBuffers()
 	// Round up, since part of a frame requires a full frame.
 	u32 numFrames = (u32)((m_totalSize + m_frameSize - 1) / m_frameSize);
 
-	// We might read a bit of alignment too, so be prepared.
-	if (m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = new u8[CSO_READ_BUFFER_SIZE];
-	}
-	else
-	{
-		m_readBuffer = new u8[m_frameSize + (1 << m_indexShift)];
-	}
-
-	// This is a buffer for the most recently decompressed frame.
-	m_zlibBuffer = new u8[m_frameSize + (1 << m_indexShift)];
-	m_zlibBufferFrame = numFrames;
-
 	const u32 indexSize = numFrames + 1;
 	m_index = new u32[indexSize];
 	if (fread(m_index, sizeof(u32), indexSize, m_src) != indexSize)
@@ -164,14 +153,33 @@ bool CsoFileReader::InitializeBuffers()
 		return false;
 	}
 
-	m_z_stream = new z_stream;
-	m_z_stream->zalloc = Z_NULL;
-	m_z_stream->zfree = Z_NULL;
-	m_z_stream->opaque = Z_NULL;
-	if (inflateInit2(m_z_stream, -15) != Z_OK)
+	// We might read a bit of alignment too, so be prepared.
+	const u32 readBufferSize = std::max<u32>(CSO_READ_BUFFER_SIZE, m_frameSize + (1 << m_indexShift));
+
+	const uint workers = ReadaheadCache::GetMaxWorkers();
+	for (uint i = 0; i < workers; i++)
 	{
-		log_cb(RETRO_LOG_ERROR, "Unable to initialize zlib for CSO decompression.\n");
-		return false;
+		Decoder decoder = {};
+		decoder.src = PX_fopen_rb(m_filename);
+		if (!decoder.src)
+		{
+			log_cb(RETRO_LOG_ERROR, "Unable to open CSO file for decompression.\n");
+			return false;
+		}
+		decoder.readBuffer = new u8[readBufferSize];
+		m_decoders.push_back(decoder);
+
+		z_stream* strm = new z_stream;
+		strm->zalloc = Z_NULL;
+		strm->zfree = Z_NULL;
+		strm->opaque = Z_NULL;
+		if (inflateInit2(strm, -15) != Z_OK)
+		{
+			log_cb(RETRO_LOG_ERROR, "Unable to initialize zlib for CSO decompression.\n");
+			delete strm;
+			return false;
+		}
+		m_decoders.back().strm = strm;
 	}
 
 	return true;
@@ -179,32 +187,28 @@ bool CsoFileReader::InitializeBuffers()
 
 void CsoFileReader::Close()
 {
+	// The workers use the decoders, stop them first.
+	m_cache.Stop();
 	m_filename.Empty();
-#if CSO_USE_CHUNKSCACHE
-	m_cache.Clear();
-#endif
 
 	if (m_src)
 	{
 		fclose(m_src);
 		m_src = NULL;
 	}
-	if (m_z_stream)
-	{
-		inflateEnd(m_z_stream);
-		m_z_stream = NULL;
-	}
 
-	if (m_readBuffer)
-	{
-		delete[] m_readBuffer;
-		m_readBuffer = NULL;
-	}
-	if (m_zlibBuffer)
+	for (Decoder& decoder : m_decoders)
 	{
-		delete[] m_zlibBuffer;
-		m_zlibBuffer = NULL;
+		if (decoder.strm)
+		{
+			inflateEnd(decoder.strm);
+			delete decoder.strm;
+		}
+		delete[] decoder.readBuffer;
+		fclose(decoder.src);
 	}
+	m_decoders.clear();
+
 	if (m_index)
 	{
 		delete[] m_index;
@@ -228,31 +232,16 @@ int CsoFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	int remaining = count * m_blocksize;
 	int bytes = 0;
 
+	// Have the frames of larger reads decompressed concurrently.
+	m_cache.Prefetch(pos, remaining);
+
 	while (remaining > 0)
 	{
-		int readBytes;
-
-#if CSO_USE_CHUNKSCACHE
-		// Try first to read from the cache.
-		readBytes = m_cache.Read(dest + bytes, pos + bytes, remaining);
-#else
-		readBytes = -1;
-#endif
-		if (readBytes < 0)
+		int readBytes = m_cache.Read(dest + bytes, pos + bytes, remaining);
+		if (readBytes <= 0)
 		{
-			readBytes = ReadFromFrame(dest + bytes, pos + bytes, remaining);
-			if (readBytes == 0)
-			{
-				// We hit EOF.
-				break;
-			}
-
-#if CSO_USE_CHUNKSCACHE
-			// Add the bytes into the cache.  We need to allocate a buffer for it.
-			void* cached = malloc(readBytes);
-			memcpy(cached, dest + bytes, readBytes);
-			m_cache.Take(cached, pos + bytes, readBytes, readBytes);
-#endif
+			// We hit EOF, or the frame couldn't be read.
+			break;
 		}
 
 		bytes += readBytes;
@@ -262,18 +251,20 @@ int CsoFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	return bytes;
 }
 
-int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
+// Called on the readahead threads only, with the decoder of the thread.
+int CsoFileReader::DecodeFrame(u32 frame, u8* dest, uint worker)
 {
+	Decoder& decoder = m_decoders[worker];
+
+	const u64 pos = (u64)frame << m_frameShift;
 	if (pos >= m_totalSize)
 	{
 		// Can't read anything passed the end.
 		return 0;
 	}
 
-	const u32 frame = (u32)(pos >> m_frameShift);
-	const u32 offset = (u32)(pos - (frame << m_frameShift));
-	// This is how many bytes we will actually be reading from this frame.
-	const u32 bytes = (u32)(std::min(m_blocksize, static_cast<uint>(m_frameSize - offset)));
+	// The last frame is decompressed whole, but only the image part of it is used.
+	const u32 bytes = (u32)std::min<u64>(m_frameSize, m_totalSize - pos);
 
 	// Grab the index data for the frame we're about to read.
 	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
@@ -287,77 +278,64 @@ int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
 	if (!compressed)
 	{
 		// Just read directly, easy.
-		if (PX_fseeko(m_src, m_dataoffset + frameRawPos + offset, SEEK_SET) != 0)
+		if (PX_fseeko(decoder.src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
 		{
 			log_cb(RETRO_LOG_ERROR, "Unable to seek to uncompressed CSO data.\n");
-			return 0;
+			return -1;
 		}
-		return fread(dest, 1, bytes, m_src);
+		return fread(dest, 1, bytes, decoder.src);
 	}
-	else
-	{
-		// We don't need to decompress if we already did this same frame last time.
-		if (m_zlibBufferFrame != frame)
-		{
-			if (PX_fseeko(m_src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
-			{
-				log_cb(RETRO_LOG_ERROR, "Unable to seek to compressed CSO data.\n");
-				return 0;
-			}
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
-			if (!DecompressFrame(frame, readRawBytes))
-			{
-				return 0;
-			}
-		}
 
-		// Now we just copy the offset data from the cache.
-		memcpy(dest, m_zlibBuffer + offset, bytes);
+	if (PX_fseeko(decoder.src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
+	{
+		log_cb(RETRO_LOG_ERROR, "Unable to seek to compressed CSO data.\n");
+		return -1;
 	}
+	// This might be less bytes than frameRawSize in case of padding on the last frame.
+	// This is because the index positions must be aligned.
+	const u32 readRawBytes = fread(decoder.readBuffer, 1, frameRawSize, decoder.src);
 
-	return bytes;
-}
+	decoder.strm->next_in = decoder.readBuffer;
+	decoder.strm->avail_in = readRawBytes;
+	decoder.strm->next_out = dest;
+	decoder.strm->avail_out = m_frameSize;
 
-bool CsoFileReader::DecompressFrame(u32 frame, u32 readBufferSize)
-{
-	m_z_stream->next_in = m_readBuffer;
-	m_z_stream->avail_in = readBufferSize;
-	m_z_stream->next_out = m_zlibBuffer;
-	m_z_stream->avail_out = m_frameSize;
-
-	int status = inflate(m_z_stream, Z_FINISH);
-	bool success = status == Z_STREAM_END && m_z_stream->total_out == m_frameSize;
-	if (success)
-	{
-		// Our buffer now contains this frame.
-		m_zlibBufferFrame = frame;
-	}
-	else
+	int status = inflate(decoder.strm, Z_FINISH);
+	bool success = status == Z_STREAM_END && decoder.strm->total_out == m_frameSize;
+	inflateReset(decoder.strm);
+
+	if (!success)
 	{
 		log_cb(RETRO_LOG_ERROR, "Unable to decompress CSO frame using zlib.\n");
-		m_zlibBufferFrame = (u32)-1;
+		return -1;
 	}
 
-	inflateReset(m_z_stream);
-	return success;
+	return bytes;
 }
 
 void CsoFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
-	// TODO: No async support yet, implement as sync.
-	m_bytesRead = ReadSync(pBuffer, sector, count);
+	m_pendingBuffer = pBuffer;
+	m_pendingSector = sector;
+	m_pendingCount = count;
+
+	// Get the workers going, the data is copied out in FinishRead().
+	m_cache.Prefetch((u64)sector * (u64)m_blocksize, count * m_blocksize);
 }
 
 int CsoFileReader::FinishRead()
 {
-	int res = m_bytesRead;
-	m_bytesRead = -1;
+	if (!m_pendingBuffer)
+	{
+		return -1;
+	}
+
+	int res = ReadSync(m_pendingBuffer, m_pendingSector, m_pendingCount);
+	m_pendingBuffer = NULL;
 	return res;
 }
 
 void CsoFileReader::CancelRead()
 {
-	// TODO: No async read support yet.
+	m_pendingBuffer = NULL;
 }
@@ -15,23 +15,12 @@
 
 #pragma once
 
-// Based on testing, the overhead of using this cache is high.
-//
-// The test was done with CSO files using a block size of 16KB.
-// Cache hit rates were observed in the range of 25%.
-// Cache overhead added 35% to the overall read time.
-//
-// For this reason, it's currently disabled.
-#define CSO_USE_CHUNKSCACHE 0
-
 #include "AsyncFileReader.h"
-#include "ChunksCache.h"
+#include "ReadaheadCache.h"
 
 struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
-static const uint CSO_CHUNKCACHE_SIZE_MB = 200;
-
 class CsoFileReader : public AsyncFileReader
 {
 	DeclareNoncopyableObject(CsoFileReader);
@@ -41,19 +30,12 @@ public:
 		: m_frameSize(0)
 		, m_frameShift(0)
 		, m_indexShift(0)
-		, m_readBuffer(0)
-		, m_zlibBuffer(0)
-		, m_zlibBufferFrame(0)
 		, m_index(0)
 		, m_totalSize(0)
 		, m_src(0)
-		, m_z_stream(0)
-		,
-#if CSO_USE_CHUNKSCACHE
-		m_cache(CSO_CHUNKCACHE_SIZE_MB)
-		,
-#endif
-		m_bytesRead(0)
+		, m_pendingBuffer(0)
+		, m_pendingSector(0)
+		, m_pendingCount(0)
 	{
 		m_blocksize = 2048;
 	};
@@ -83,25 +65,30 @@ private:
 	static bool ValidateHeader(const CsoHeader& hdr);
 	bool ReadFileHeader();
 	bool InitializeBuffers();
-	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
-	bool DecompressFrame(u32 frame, u32 readBufferSize);
+	int DecodeFrame(u32 frame, u8* dest, uint worker);
+
+	// Each readahead worker reads and inflates frames with its own file handle and stream.
+	struct Decoder
+	{
+		FILE* src;
+		u8* readBuffer;
+		z_stream* strm;
+	};
 
 	u32 m_frameSize;
 	u8 m_frameShift;
 	u8 m_indexShift;
-	u8* m_readBuffer;
-	u8* m_zlibBuffer;
-	u32 m_zlibBufferFrame;
 	u32* m_index;
 	u64 m_totalSize;
 	// The actual source cso file handle.
 	FILE* m_src;
-	z_stream* m_z_stream;
+	std::vector<Decoder> m_decoders;
 
-#if CSO_USE_CHUNKSCACHE
-	ChunksCache m_cache;
-#endif
+	// Frames are decompressed on worker threads, ahead of sequential reads and concurrently.
+	ReadaheadCache m_cache;
 
-	// The result of a read is stored here between BeginRead() and FinishRead().
-	int m_bytesRead;
+	// The request is stored here between BeginRead() and FinishRead().
+	void* m_pendingBuffer;
+	uint m_pendingSector;
+	uint m_pendingCount;
 };
@@ -17,13 +17,10 @@
 #include <fstream>
 #include <wx/stdpaths.h>
 #include "AppConfig.h"
-#include "ChunksCache.h"
 #include "CompressedFileReaderUtils.h"
 #include "GzippedFileReader.h"
 #include "zlib_indexed.h"
 
-#define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
-
 static s64 fsize(const wxString& filename)
 {
 	if (!wxFileName::FileExists(filename))
@@ -164,111 +161,71 @@ static wxString iso2indexname(const wxString& isoname)
 }
 
 GzippedFileReader::GzippedFileReader(void)
-	: mBytesRead(0)
-	, m_pIndex(0)
+	: m_pIndex(0)
 	, m_zstates(0)
-	, m_src(0)
-	, m_cache(GZFILE_CACHE_SIZE_MB)
+	, m_readahead(GZFILE_CACHE_SIZE_MB)
+	, m_builtIndex(0)
+	, m_buildDone(false)
+	, m_buildAbort(false)
+	, m_estimatedSize(0)
+	, m_pendingBuffer(0)
+	, m_pendingSector(0)
+	, m_pendingCount(0)
 {
 	m_blocksize = 2048;
-	AsyncPrefetchReset();
 };
 
-void GzippedFileReader::InitZstates()
+bool GzippedFileReader::InitWorkers()
 {
-	if (m_zstates)
+	CloseWorkers();
+
+	// Until the index is built, a single worker continues one inflate stream.
+	const uint workers = m_pIndex ? ReadaheadCache::GetMaxWorkers() : 1;
+	for (uint i = 0; i < workers; i++)
 	{
-		delete[] m_zstates;
-		m_zstates = 0;
+		FILE* src = PX_fopen_rb(m_filename);
+		if (!src)
+			return false;
+		m_workerFiles.push_back(src);
 	}
-	if (!m_pIndex)
-		return;
-
-	// having another extra element helps avoiding logic for last (so 2+ instead of 1+)
-	int size = 2 + m_pIndex->uncompressed_size / m_pIndex->span;
-	m_zstates = new Czstate[size]();
-}
-
-#ifndef _WIN32
-void GzippedFileReader::AsyncPrefetchReset(){};
-void GzippedFileReader::AsyncPrefetchOpen(){};
-void GzippedFileReader::AsyncPrefetchClose(){};
-void GzippedFileReader::AsyncPrefetchChunk(PX_off_t dummy){};
-void GzippedFileReader::AsyncPrefetchCancel(){};
-#else
-// AsyncPrefetch works as follows:
-// ater extracting a chunk from the compressed file, ask the OS to asynchronously
-// read the next chunk from the file, and then completely ignore the result and
-// cancel the async read before the next extract. the next extract then reads the
-// data from the disk buf if it's overlapping/contained within the chunk we've
-// asked the OS to prefetch, then the OS is likely to already have it cached.
-// This procedure is frequently able to overcome seek time due to fragmentation of the
-// compressed file on disk without any meaningful penalty.
-// This system is only enabled for win32 where we have this async read request.
-void GzippedFileReader::AsyncPrefetchReset()
-{
-	hOverlappedFile = INVALID_HANDLE_VALUE;
-	asyncInProgress = false;
-}
-
-void GzippedFileReader::AsyncPrefetchOpen()
-{
-	hOverlappedFile = CreateFile(
-		m_filename,
-		GENERIC_READ,
-		FILE_SHARE_READ,
-		NULL,
-		OPEN_EXISTING,
-		FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED,
-		NULL);
-};
-
-void GzippedFileReader::AsyncPrefetchClose()
-{
-	AsyncPrefetchCancel();
-
-	if (hOverlappedFile != INVALID_HANDLE_VALUE)
-		CloseHandle(hOverlappedFile);
+	m_zstates = new Czstate[workers]();
 
-	AsyncPrefetchReset();
-};
-
-void GzippedFileReader::AsyncPrefetchChunk(PX_off_t start)
-{
-	if (hOverlappedFile == INVALID_HANDLE_VALUE || asyncInProgress)
+	if (!m_pIndex)
 	{
-		log_cb(RETRO_LOG_ERROR, "Unexpected file handle or progress state. Aborting prefetch.\n");
-		return;
+		m_readahead.Start(GZFILE_BUILD_BLOCK_SIZE, m_estimatedSize, [this](u32 block, u8* dest, uint worker) {
+			return ExtractPartial(m_workerFiles[worker], (PX_off_t)block * GZFILE_BUILD_BLOCK_SIZE, dest, GZFILE_BUILD_BLOCK_SIZE,
+				&m_zstates[worker].state);
+		});
+		return true;
 	}
 
-	LARGE_INTEGER offset;
-	offset.QuadPart = start;
-
-	DWORD bytesToRead = GZFILE_READ_CHUNK_SIZE;
+	// Every access point starts a span that extracts without skipping any data.
+	std::vector<u64> spans(m_pIndex->have);
+	for (int i = 0; i < m_pIndex->have; i++)
+		spans[i] = m_pIndex->list[i].out;
 
-	ZeroMemory(&asyncOperationContext, sizeof(asyncOperationContext));
-	asyncOperationContext.hEvent = 0;
-	asyncOperationContext.Offset = offset.LowPart;
-	asyncOperationContext.OffsetHigh = offset.HighPart;
-
-	ReadFile(hOverlappedFile, mDummyAsyncPrefetchTarget, bytesToRead, NULL, &asyncOperationContext);
-	asyncInProgress = true;
-};
+	m_readahead.Start(spans, m_pIndex->uncompressed_size, [this](u32 span, u8* dest, uint worker) {
+		return ExtractSpan(span, dest, worker);
+	},
+		workers);
+	return true;
+}
 
-void GzippedFileReader::AsyncPrefetchCancel()
+void GzippedFileReader::CloseWorkers()
 {
-	if (!asyncInProgress)
-		return;
+	// The workers use the files, the states and the index, stop them first.
+	m_readahead.Stop();
 
-	if (!CancelIo(hOverlappedFile))
+	if (m_zstates)
 	{
-		log_cb(RETRO_LOG_ERROR, "canceling gz prefetch failed. following prefetching will not work.\n");
-		return;
+		delete[] m_zstates;
+		m_zstates = 0;
 	}
 
-	asyncInProgress = false;
-};
-#endif /* _WIN32 */
+	for (FILE* src : m_workerFiles)
+		fclose(src);
+	m_workerFiles.clear();
+}
 
 // TODO: do better than just checking existance and extension
 bool GzippedFileReader::CanHandle(const wxString& fileName)
@@ -298,72 +255,235 @@ bool GzippedFileReader::OkIndex()
 			log_cb(RETRO_LOG_WARN, "(smaller intervals mean bigger index file and quicker but more frequent decompressions)\n");
 		}
 #endif
-		InitZstates();
 		return true;
 	}
 
-	// No valid index file. Generate an index
-	log_cb(RETRO_LOG_WARN, "This may take a while (but only once). Scanning compressed file to generate a quick access index...\n");
+	// No valid index file. Build one in the background, the image can be read meanwhile.
+	log_cb(RETRO_LOG_INFO, "Scanning compressed file in the background to generate a quick access index...\n");
+
+	m_buildDone = false;
+	m_buildAbort = false;
+	m_indexThread = std::thread(&GzippedFileReader::BuildIndex, this, wxString(m_filename), indexfile);
 
-	Access* index;
-	FILE* infile = PX_fopen_rb(m_filename);
-	int len = build_index(infile, GZFILE_SPAN_DEFAULT, &index);
+	m_estimatedSize = EstimateUncompressedSize();
+	if (m_estimatedSize > 0)
+		return true;
+
+	// The size can't be guessed, wait for the index.
+	m_indexThread.join();
+	std::swap(m_pIndex, m_builtIndex);
+	StopIndexBuild();
+	return m_pIndex != NULL;
+}
+
+void GzippedFileReader::BuildIndex(wxString filename, wxString indexfile)
+{
+	Access* index = NULL;
+	FILE* infile = PX_fopen_rb(filename);
+	int len = infile ? build_index(infile, GZFILE_SPAN_DEFAULT, &index, IndexPointAdded, this) : Z_ERRNO;
 	printf("\n"); // build_index prints progress without \n's
-	fclose(infile);
+	if (infile)
+		fclose(infile);
+
+	if (len > 0)
+		WriteIndexToFile(index, indexfile);
+	else if (!m_buildAbort)
+		log_cb(RETRO_LOG_ERROR, "ERROR (%d): index could not be generated for file '%s'\n", len, WX_STR(filename));
 
-	if (len >= 0)
 	{
-		m_pIndex = index;
-		WriteIndexToFile((Access*)m_pIndex, indexfile);
+		std::lock_guard<std::mutex> lock(m_indexLock);
+		m_builtIndex = len > 0 ? index : NULL;
+		m_buildDone = true;
 	}
-	else
+	m_indexProgress.notify_all();
+}
+
+int GzippedFileReader::IndexPointAdded(void* ctx, const Access* index)
+{
+	GzippedFileReader* reader = (GzippedFileReader*)ctx;
+	if (reader->m_buildAbort)
+		return 0;
+
 	{
-		log_cb(RETRO_LOG_ERROR, "ERROR (%d): index could not be generated for file '%s'\n", len, WX_STR(m_filename));
-		free_index(index);
-		InitZstates();
-		return false;
+		std::lock_guard<std::mutex> lock(reader->m_indexLock);
+		reader->m_buildPoints.push_back(index->list[index->have - 1]);
 	}
+	reader->m_indexProgress.notify_all();
+	return 1;
+}
 
-	InitZstates();
-	return true;
+void GzippedFileReader::StopIndexBuild()
+{
+	if (m_indexThread.joinable())
+	{
+		m_buildAbort = true;
+		m_indexThread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(m_indexLock);
+	if (m_builtIndex)
+	{
+		free_index(m_builtIndex);
+		m_builtIndex = 0;
+	}
+	m_buildPoints.clear();
+}
+
+// Called on the reader thread, switches to the index once it's built.
+void GzippedFileReader::UpdateIndex()
+{
+	if (m_pIndex || !m_buildDone || !m_indexThread.joinable())
+		return;
+
+	m_indexThread.join();
+
+	if (!m_builtIndex)
+		return; // keep extracting from the access points that were found
+
+	std::swap(m_pIndex, m_builtIndex);
+	StopIndexBuild();
+
+	if (m_pIndex->uncompressed_size != m_estimatedSize)
+		log_cb(RETRO_LOG_WARN, "Gzip image size was estimated as %lld bytes but is %lld, reopen it to read it whole.\n",
+			(long long)m_estimatedSize, (long long)m_pIndex->uncompressed_size);
+
+	InitWorkers();
+}
+
+// Extracts with the access points found so far, waiting for the first one.
+int GzippedFileReader::ExtractPartial(FILE* src, PX_off_t offset, u8* dest, int len, Zstate* state)
+{
+	Point here;
+	Access access = {};
+	access.have = 1;
+	access.list = &here;
+
+	if (!state->isValid || state->out_offset != offset)
+	{
+		std::unique_lock<std::mutex> lock(m_indexLock);
+		m_indexProgress.wait(lock, [this] { return !m_buildPoints.empty() || m_buildDone; });
+		if (m_buildPoints.empty())
+			return Z_DATA_ERROR;
+
+		// The first point is at 0, so there's always one at or before offset.
+		auto it = std::upper_bound(m_buildPoints.begin(), m_buildPoints.end(), offset,
+			[](PX_off_t value, const Point& point) { return value < point.out; });
+		here = *(it - 1);
+	}
+
+	return extract(src, &access, offset, dest, len, state);
+}
+
+// The gzip trailer only has the size modulo 4GB.  The image is at least as large as the ISO
+// volume it holds, and hardly smaller than the compressed file, so the smallest size above
+// both that matches the trailer is used.
+PX_off_t GzippedFileReader::EstimateUncompressedSize()
+{
+	FILE* src = PX_fopen_rb(m_filename);
+	if (!src)
+		return 0;
+
+	u8 magic[2] = {};
+	u32 isize = 0;
+	bool gzip = fread(magic, 1, 2, src) == 2 && magic[0] == 0x1f && magic[1] == 0x8b &&
+				PX_fseeko(src, -4, SEEK_END) == 0 && fread(&isize, 1, 4, src) == 4;
+	PX_off_t compressed = PX_ftello(src);
+
+	if (!gzip)
+	{
+		fclose(src);
+		return 0;
+	}
+
+	PX_off_t lower = compressed - compressed / 256;
+
+	// Primary volume descriptor at sector 16, for 2048 byte sectors or raw CD sectors.
+	static const int layouts[][2] = {{16 * 2048, 2048}, {16 * 2352 + 24, 2352}, {16 * 2352 + 16, 2352}};
+
+	std::vector<u8> head(17 * 2352);
+	Czstate state;
+	int len = ExtractPartial(src, 0, head.data(), head.size(), &state.state);
+	fclose(src);
+
+	for (const auto& layout : layouts)
+	{
+		const u8* pvd = &head[layout[0]];
+		if (layout[0] + 2048 <= len && pvd[0] == 1 && memcmp(pvd + 1, "CD001", 5) == 0)
+		{
+			lower = std::max(lower, (PX_off_t) * (u32*)(pvd + 80) * layout[1]);
+			break;
+		}
+	}
+
+	PX_off_t size = isize;
+	while (size < lower)
+		size += 0x100000000LL;
+
+	return size;
 }
 
 bool GzippedFileReader::Open(const wxString& fileName)
 {
 	Close();
 	m_filename = fileName;
-	if (!(m_src = PX_fopen_rb(m_filename)) || !CanHandle(fileName) || !OkIndex())
+	if (!CanHandle(fileName) || !OkIndex() || !InitWorkers())
 	{
 		Close();
 		return false;
 	};
 
-	AsyncPrefetchOpen();
 	return true;
 };
 
 void GzippedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
-	// No a-sync support yet, implement as sync
-	mBytesRead = ReadSync(pBuffer, sector, count);
-	return;
+	UpdateIndex();
+
+	m_pendingBuffer = pBuffer;
+	m_pendingSector = sector;
+	m_pendingCount = count;
+
+	// Get the workers going, the data is copied out in FinishRead().
+	m_readahead.Prefetch((s64)sector * m_blocksize + m_dataoffset, count * m_blocksize);
 };
 
 int GzippedFileReader::FinishRead(void)
 {
-	int res = mBytesRead;
-	mBytesRead = -1;
+	if (!m_pendingBuffer)
+		return -1;
+
+	int res = ReadSync(m_pendingBuffer, m_pendingSector, m_pendingCount);
+	m_pendingBuffer = 0;
 	return res;
 };
 
-#define PTT clock_t
-#define NOW() (clock() / (CLOCKS_PER_SEC / 1000))
+void GzippedFileReader::CancelRead(void)
+{
+	m_pendingBuffer = 0;
+}
 
 int GzippedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 {
+	UpdateIndex();
+
 	PX_off_t offset = (s64)sector * m_blocksize + m_dataoffset;
 	int bytesToRead = count * m_blocksize;
-	int res = _ReadSync(pBuffer, offset, bytesToRead);
+	int res = 0;
+
+	// The spans are extracted by the readahead threads, copy them out.
+	m_readahead.Prefetch(offset, bytesToRead);
+
+	while (bytesToRead > 0)
+	{
+		int copied = m_readahead.Read((char*)pBuffer + res, offset + res, bytesToRead);
+		if (copied < 0 && res == 0)
+			res = copied;
+		if (copied <= 0)
+			break;
+
+		res += copied;
+		bytesToRead -= copied;
+	}
 #ifndef NDEBUG
 	if (res < 0)
 		log_cb(RETRO_LOG_ERROR, "Error: iso-gzip read unsuccessful.\n");
@@ -371,132 +491,38 @@ int GzippedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	return res;
 }
 
-// If we have a valid and adequate zstate for this span, use it, else, use the index
-PX_off_t GzippedFileReader::GetOptimalExtractionStart(PX_off_t offset)
-{
-	int span = m_pIndex->span;
-	Czstate& cstate = m_zstates[offset / span];
-	PX_off_t stateOffset = cstate.state.isValid ? cstate.state.out_offset : 0;
-	if (stateOffset && stateOffset <= offset)
-		return stateOffset; // state is faster than indexed
-
-	// If span is not exact multiples of GZFILE_READ_CHUNK_SIZE (because it was configured badly),
-	// we fallback to always GZFILE_READ_CHUNK_SIZE boundaries
-	if (span % GZFILE_READ_CHUNK_SIZE)
-		return offset / GZFILE_READ_CHUNK_SIZE * GZFILE_READ_CHUNK_SIZE;
-
-	return span * (offset / span); // index direct access boundaries
-}
+#define PTT clock_t
+#define NOW() (clock() / (CLOCKS_PER_SEC / 1000))
 
-int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRead)
+// Called on the readahead threads only, with the state of the thread.
+int GzippedFileReader::ExtractSpan(u32 span, u8* dest, uint worker)
 {
-	if (!OkIndex())
-		return -1;
-
-	// Without all the caching, chunking and states, this would be enough:
-	// return extract(m_src, m_pIndex, offset, (unsigned char*)pBuffer, bytesToRead);
-
-	// Split request to GZFILE_READ_CHUNK_SIZE chunks at GZFILE_READ_CHUNK_SIZE boundaries
-	uint maxInChunk = GZFILE_READ_CHUNK_SIZE - offset % GZFILE_READ_CHUNK_SIZE;
-	if (bytesToRead > maxInChunk)
-	{
-		int first = _ReadSync(pBuffer, offset, maxInChunk);
-		if (first != (int)maxInChunk)
-			return first; // EOF or failure
-
-		int rest = _ReadSync((char*)pBuffer + maxInChunk, offset + maxInChunk, bytesToRead - maxInChunk);
-		if (rest < 0)
-			return rest;
-
-		return first + rest;
-	}
-
-	// From here onwards it's guarenteed that the request is inside a single GZFILE_READ_CHUNK_SIZE boundaries
-
-	int res = m_cache.Read(pBuffer, offset, bytesToRead);
-	if (res >= 0)
-		return res;
-
-	// Not available from cache. Decompress from optimal starting
-	// point in GZFILE_READ_CHUNK_SIZE chunks and cache each chunk.
 	PTT s = NOW();
-	PX_off_t extractOffset = GetOptimalExtractionStart(offset); // guaranteed in GZFILE_READ_CHUNK_SIZE boundaries
-	int size = offset + maxInChunk - extractOffset;
-	unsigned char* extracted = (unsigned char*)malloc(size);
-
-	int span = m_pIndex->span;
-	int spanix = extractOffset / span;
-	AsyncPrefetchCancel();
-	res = extract(m_src, m_pIndex, extractOffset, extracted, size, &(m_zstates[spanix].state));
-	if (res < 0)
-	{
-		free(extracted);
-		return res;
-	}
-	AsyncPrefetchChunk(getInOffset(&(m_zstates[spanix].state)));
+	PX_off_t start = m_pIndex->list[span].out;
+	PX_off_t end = span + 1 < (u32)m_pIndex->have ? m_pIndex->list[span + 1].out : m_pIndex->uncompressed_size;
+	int size = (int)(end - start);
 
-	int copied = ChunksCache::CopyAvailable(extracted, extractOffset, res, pBuffer, offset, bytesToRead);
-
-	if (m_zstates[spanix].state.isValid && (extractOffset + res) / span != offset / span)
-	{
-		// The state no longer matches this span.
-		// move the state to the appropriate span because it will be faster than using the index
-		int targetix = (extractOffset + res) / span;
-		m_zstates[targetix].Kill();
-		// We have elements for the entire file, and another one.
-		m_zstates[targetix].state.in_offset = m_zstates[spanix].state.in_offset;
-		m_zstates[targetix].state.isValid = m_zstates[spanix].state.isValid;
-		m_zstates[targetix].state.out_offset = m_zstates[spanix].state.out_offset;
-		inflateCopy(&m_zstates[targetix].state.strm, &m_zstates[spanix].state.strm);
-
-		m_zstates[spanix].Kill();
-	}
-
-	if (size <= GZFILE_READ_CHUNK_SIZE)
-		m_cache.Take(extracted, extractOffset, res, size);
-	else
-	{ // split into cacheable chunks
-		for (int i = 0; i < size; i += GZFILE_READ_CHUNK_SIZE)
-		{
-			int available = CLAMP(res - i, 0, GZFILE_READ_CHUNK_SIZE);
-			void* chunk = available ? malloc(available) : 0;
-			if (available)
-				memcpy(chunk, extracted + i, available);
-			m_cache.Take(chunk, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
-		}
-		free(extracted);
-	}
+	int res = extract(m_workerFiles[worker], m_pIndex, start, dest, size, &m_zstates[worker].state);
 
 	int duration = NOW() - s;
 #ifndef NDEBUG
 	if (duration > 10)
-		log_cb(RETRO_LOG_INFO, "gunzip: chunk #%5d-%2d : %1.2f MB - %d ms\n",
-						(int)(offset / 4 / 1024 / 1024),
-						(int)(offset % (4 * 1024 * 1024) / GZFILE_READ_CHUNK_SIZE),
-						(float)size / 1024 / 1024,
-						duration);
+		log_cb(RETRO_LOG_INFO, "gunzip: span #%5d : %1.2f MB - %d ms\n",
+						(int)span, (float)size / 1024 / 1024, duration);
 #endif
 
-	return copied;
+	return res;
 }
 
 void GzippedFileReader::Close()
 {
+	// Stop the build first, the worker may be waiting for it.
+	StopIndexBuild();
+	CloseWorkers();
 	m_filename.Empty();
 	if (m_pIndex)
 	{
 		free_index((Access*)m_pIndex);
 		m_pIndex = 0;
 	}
-
-	InitZstates(); // results in delete because no index
-	m_cache.Clear();
-
-	if (m_src)
-	{
-		fclose(m_src);
-		m_src = 0;
-	}
-
-	AsyncPrefetchClose();
 }
@@ -18,12 +18,15 @@
 typedef struct zstate Zstate;
 
 #include "AsyncFileReader.h"
-#include "ChunksCache.h"
+#include "ReadaheadCache.h"
 #include "zlib_indexed.h"
 
-#define GZFILE_SPAN_DEFAULT (1048576L * 4)  /* distance between direct access points when creating a new index */
-#define GZFILE_READ_CHUNK_SIZE (256 * 1024) /* zlib extraction chunks size (at 0-based boundaries) */
-#define GZFILE_CACHE_SIZE_MB 200            /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
+#include <atomic>
+#include <deque>
+
+#define GZFILE_SPAN_DEFAULT (1048576L * 4) /* distance between direct access points when creating a new index */
+#define GZFILE_CACHE_SIZE_MB 200           /* cache size for extracted data */
+#define GZFILE_BUILD_BLOCK_SIZE (1024 * 1024) /* extraction unit while the index is being built */
 
 class GzippedFileReader : public AsyncFileReader
 {
@@ -41,7 +44,7 @@ public:
 
 	virtual void BeginRead(void* pBuffer, uint sector, uint count);
 	virtual int FinishRead(void);
-	virtual void CancelRead(void){};
+	virtual void CancelRead(void);
 
 	virtual void Close(void);
 
@@ -49,7 +52,8 @@ public:
 	{
 		// type and formula copied from FlatFileReader
 		// FIXME? : Shouldn't it be uint and (size - m_dataoffset) / m_blocksize ?
-		return (int)((m_pIndex ? m_pIndex->uncompressed_size : 0) / m_blocksize);
+		// While the index is built, the size is an estimate (see EstimateUncompressedSize).
+		return (int)((m_pIndex ? m_pIndex->uncompressed_size : m_estimatedSize) / m_blocksize);
 	};
 
 	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
@@ -70,29 +74,44 @@ private:
 		Zstate state;
 	};
 
-	bool OkIndex(); // Verifies that we have an index, or try to create one
-	PX_off_t GetOptimalExtractionStart(PX_off_t offset);
-	int _ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRead);
-	void InitZstates();
+	bool OkIndex(); // Verifies that we have an index, or starts building one
+	bool InitWorkers();
+	void CloseWorkers();
+	int ExtractSpan(u32 span, u8* dest, uint worker);
+
+	// Building the index on first open
+	void BuildIndex(wxString filename, wxString indexfile);
+	static int IndexPointAdded(void* ctx, const Access* index);
+	void StopIndexBuild();
+	void UpdateIndex();
+	int ExtractPartial(FILE* src, PX_off_t offset, u8* dest, int len, Zstate* state);
+	PX_off_t EstimateUncompressedSize();
 
-	int mBytesRead;   // Temp sync read result when simulating async read
 	Access* m_pIndex; // Quick access index
+
+	// Each readahead worker extracts with its own file handle and inflate state. The state is
+	// kept after a span, so a worker that extracts the next span continues where it stopped.
+	std::vector<FILE*> m_workerFiles;
 	Czstate* m_zstates;
-	FILE* m_src;
-
-	ChunksCache m_cache;
-
-#ifdef _WIN32
-	// Used by async prefetch
-	HANDLE hOverlappedFile;
-	OVERLAPPED asyncOperationContext;
-	bool asyncInProgress;
-	byte mDummyAsyncPrefetchTarget[GZFILE_READ_CHUNK_SIZE];
-#endif
-
-	void AsyncPrefetchReset();
-	void AsyncPrefetchOpen();
-	void AsyncPrefetchClose();
-	void AsyncPrefetchChunk(PX_off_t dummy);
-	void AsyncPrefetchCancel();
+
+	// The spans between the index access points are extracted on worker threads, ahead of
+	// sequential reads and concurrently.
+	ReadaheadCache m_readahead;
+
+	// Without an index file, the index is built on a thread while the game runs.  Until it's
+	// done, a single worker extracts from the access points found so far, continuing its own
+	// inflate state for sequential reads, and m_pIndex is NULL.
+	std::thread m_indexThread;
+	std::mutex m_indexLock;
+	std::condition_variable m_indexProgress;
+	std::deque<Point> m_buildPoints; // grows, so points stay where they are
+	Access* m_builtIndex;
+	std::atomic<bool> m_buildDone;
+	std::atomic<bool> m_buildAbort;
+	PX_off_t m_estimatedSize;
+
+	// The request is stored here between BeginRead() and FinishRead().
+	void* m_pendingBuffer;
+	uint m_pendingSector;
+	uint m_pendingCount;
 };
@@ -0,0 +1,322 @@
+/*  PCSX2 - PS2 Emulator for PCs
+*  Copyright (C) 2002-2014  PCSX2 Dev Team
+*
+*  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+*  of the GNU Lesser General Public License as published by the Free Software Found-
+*  ation, either version 3 of the License, or (at your option) any later version.
+*
+*  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*  PURPOSE.  See the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along with PCSX2.
+*  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PrecompiledHeader.h"
+#include "ReadaheadCache.h"
+
+#include <algorithm>
+
+static const u32 READAHEAD_MIN_BLOCK_SIZE = 64 * 1024; // smaller units are grouped up to this
+static const u32 READAHEAD_WINDOW_SIZE = 1024 * 1024;  // decompressed ahead of sequential reads
+static const uint READAHEAD_MAX_WORKERS = 4;
+
+const u32 ReadaheadCache::NoBlock;
+
+ReadaheadCache::ReadaheadCache(uint cacheLimitMb)
+	: m_cache(cacheLimitMb)
+	, m_cacheLimitMb(cacheLimitMb)
+	, m_imageSize(0)
+	, m_blockSize(0)
+	, m_maxBlockSize(0)
+	, m_blockCount(0)
+	, m_aheadBlocks(0)
+	, m_wantedNext(0)
+	, m_wantedEnd(0)
+	, m_lastBlock(NoBlock)
+	, m_aheadNext(0)
+	, m_aheadEnd(0)
+	, m_failed(NoBlock)
+	, m_exit(false)
+{
+}
+
+uint ReadaheadCache::GetMaxWorkers()
+{
+	// Leave a core to the emulator threads.
+	uint cores = std::thread::hardware_concurrency();
+	return std::min(std::max(cores, 2u) - 1, READAHEAD_MAX_WORKERS);
+}
+
+void ReadaheadCache::Start(u32 unitSize, u64 imageSize, const DecodeFunction& decode, uint workers)
+{
+	Stop();
+
+	u32 units = std::max<u32>(READAHEAD_MIN_BLOCK_SIZE / unitSize, 1);
+
+	m_imageSize = imageSize;
+	m_blockStarts.clear();
+	m_blockSize = m_maxBlockSize = unitSize * units;
+	m_blockCount = (u32)((imageSize + m_blockSize - 1) / m_blockSize);
+
+	if (units == 1)
+	{
+		StartWorkers(decode, workers);
+		return;
+	}
+
+	StartWorkers([decode, unitSize, units](u32 block, u8* dest, uint worker) {
+		int size = 0;
+
+		for (u32 i = 0; i < units; i++)
+		{
+			int res = decode(block * units + i, dest + size, worker);
+			if (res < 0)
+				return size > 0 ? size : res;
+
+			size += res;
+
+			if (res < (int)unitSize)
+				break; // end of the image
+		}
+
+		return size;
+	},
+		workers);
+}
+
+void ReadaheadCache::Start(const std::vector<u64>& blockStarts, u64 imageSize, const DecodeFunction& decode, uint workers)
+{
+	Stop();
+
+	m_imageSize = imageSize;
+	m_blockStarts = blockStarts;
+	m_blockStarts.push_back(imageSize);
+	m_blockCount = (u32)blockStarts.size();
+	m_maxBlockSize = 0;
+
+	for (u32 i = 0; i < m_blockCount; i++)
+		m_maxBlockSize = std::max(m_maxBlockSize, BlockSize(i));
+
+	m_blockSize = (u32)std::min<u64>(imageSize / std::max<u32>(m_blockCount, 1), m_maxBlockSize);
+
+	StartWorkers(decode, workers);
+}
+
+void ReadaheadCache::StartWorkers(const DecodeFunction& decode, uint workers)
+{
+	workers = std::max(workers, 1u);
+
+	m_decode = decode;
+	// Keep all the workers busy while the reads are sequential.
+	m_aheadBlocks = std::max<u32>(READAHEAD_WINDOW_SIZE / std::max<u32>(m_blockSize, 1), workers * 2);
+
+	// The window must fit in the cache, or blocks would be dropped before they are read.
+	u64 window = (u64)(m_aheadBlocks + workers + 1) * m_maxBlockSize;
+	m_cache.SetLimit(std::max<uint>(m_cacheLimitMb, (uint)((window + _1mb - 1) / _1mb)));
+
+	m_busy.assign(workers, NoBlock);
+	m_wantedNext = m_wantedEnd = 0;
+	m_lastBlock = NoBlock;
+	m_aheadNext = m_aheadEnd = 0;
+	m_failed = NoBlock;
+	m_exit = false;
+
+	for (uint i = 0; i < workers; i++)
+		m_threads.emplace_back(&ReadaheadCache::ThreadProc, this, i);
+}
+
+void ReadaheadCache::Stop()
+{
+	if (m_threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_exit = true;
+	}
+
+	m_work.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+
+	m_threads.clear();
+	m_cache.Clear();
+	m_imageSize = 0;
+	m_decode = nullptr;
+}
+
+u32 ReadaheadCache::BlockOf(u64 offset) const
+{
+	if (m_blockStarts.empty())
+		return (u32)(offset / m_blockSize);
+
+	return (u32)(std::upper_bound(m_blockStarts.begin(), m_blockStarts.end(), offset) - m_blockStarts.begin()) - 1;
+}
+
+u64 ReadaheadCache::BlockStart(u32 block) const
+{
+	if (m_blockStarts.empty())
+		return std::min((u64)block * m_blockSize, m_imageSize);
+
+	return m_blockStarts[block];
+}
+
+bool ReadaheadCache::IsCached(u32 block) const
+{
+	return m_cache.Contains(BlockStart(block), BlockSize(block));
+}
+
+bool ReadaheadCache::IsBusy(u32 block) const
+{
+	return std::find(m_busy.begin(), m_busy.end(), block) != m_busy.end();
+}
+
+// Sequential reads move the readahead window along, anything else stops reading ahead.
+void ReadaheadCache::Schedule(u32 block)
+{
+	if (block == m_lastBlock || block == m_lastBlock + 1)
+	{
+		if (m_aheadNext <= block || m_aheadNext > block + m_aheadBlocks)
+			m_aheadNext = block + 1;
+
+		m_aheadEnd = std::min(block + 1 + m_aheadBlocks, m_blockCount);
+	}
+	else
+	{
+		m_aheadNext = m_aheadEnd = 0;
+	}
+
+	m_lastBlock = block;
+}
+
+u32 ReadaheadCache::NextBlock()
+{
+	while (m_wantedNext < m_wantedEnd)
+	{
+		u32 block = m_wantedNext++;
+
+		if (!IsCached(block) && !IsBusy(block))
+			return block;
+	}
+
+	while (m_aheadNext < m_aheadEnd)
+	{
+		u32 block = m_aheadNext++;
+
+		if (!IsCached(block) && !IsBusy(block))
+			return block;
+	}
+
+	return NoBlock;
+}
+
+void ReadaheadCache::ThreadProc(uint worker)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	u8* data = NULL;
+
+	while (!m_exit)
+	{
+		u32 block = NextBlock();
+
+		if (block == NoBlock)
+		{
+			m_work.wait(lock);
+			continue;
+		}
+
+		m_busy[worker] = block;
+
+		lock.unlock();
+
+		if (!data)
+			data = (u8*)malloc(m_maxBlockSize);
+
+		int size = m_decode(block, data, worker);
+
+		lock.lock();
+
+		if (size > 0)
+		{
+			m_cache.Take(data, BlockStart(block), size, BlockSize(block));
+			data = NULL;
+		}
+		else
+		{
+			m_failed = block;
+		}
+
+		m_busy[worker] = NoBlock;
+
+		m_done.notify_all();
+	}
+
+	free(data);
+}
+
+int ReadaheadCache::Read(void* pDest, u64 offset, int length)
+{
+	if (offset >= m_imageSize || length <= 0)
+		return 0;
+
+	u32 block = BlockOf(offset);
+
+	length = (int)std::min<u64>(length, BlockStart(block + 1) - offset);
+
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	Schedule(block);
+
+	while (true)
+	{
+		int res = m_cache.Read(pDest, offset, length);
+		if (res >= 0)
+		{
+			if (m_aheadNext < m_aheadEnd)
+				m_work.notify_all();
+
+			return res;
+		}
+
+		if (m_failed == block)
+		{
+			m_failed = NoBlock;
+			return -1;
+		}
+
+		if (!IsBusy(block) && (block < m_wantedNext || block >= m_wantedEnd))
+		{
+			m_wantedNext = block;
+			m_wantedEnd = block + 1;
+			m_work.notify_one();
+		}
+
+		m_done.wait(lock);
+	}
+}
+
+void ReadaheadCache::Prefetch(u64 offset, int length)
+{
+	if (offset >= m_imageSize || length <= 0)
+		return;
+
+	u32 first = BlockOf(offset);
+	u32 last = BlockOf(std::min<u64>(offset + length, m_imageSize) - 1);
+
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	while (first <= last && IsCached(first))
+		first++;
+
+	if (first > last)
+		return;
+
+	// Reads that span several blocks have them decompressed concurrently.
+	m_wantedNext = first;
+	m_wantedEnd = last + 1;
+	m_work.notify_all();
+}
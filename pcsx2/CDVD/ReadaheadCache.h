@@ -0,0 +1,100 @@
+/*  PCSX2 - PS2 Emulator for PCs
+*  Copyright (C) 2002-2014  PCSX2 Dev Team
+*
+*  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+*  of the GNU Lesser General Public License as published by the Free Software Found-
+*  ation, either version 3 of the License, or (at your option) any later version.
+*
+*  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*  PURPOSE.  See the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along with PCSX2.
+*  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ChunksCache.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Decompresses the blocks of a compressed image on worker threads and keeps them in a
+// ChunksCache.  A block is the reader's decompression unit (frame, hunk, chunk or index span),
+// or a few of them when those are small.  The blocks a read waits for are always decompressed
+// first, and while the reads are sequential the workers keep the following blocks decompressed,
+// so that most reads only copy from the cache.
+//
+// The decoder of the reader is only ever called from the workers, each passing its own index, so
+// a reader that starts several workers needs one decompression state per worker.  The reader must
+// not touch its decompression state between Start() and Stop().
+class ReadaheadCache
+{
+	DeclareNoncopyableObject(ReadaheadCache);
+
+public:
+	// Decompresses a whole block into dest and returns its size (less than the block size at the
+	// end of the image), or a negative value on error.
+	typedef std::function<int(u32 block, u8* dest, uint worker)> DecodeFunction;
+
+	ReadaheadCache(uint cacheLimitMb = 16);
+	~ReadaheadCache() { Stop(); }
+
+	// Number of workers worth starting for decoders that can run concurrently.
+	static uint GetMaxWorkers();
+
+	// Blocks of unitSize bytes, grouped when they are small.
+	void Start(u32 unitSize, u64 imageSize, const DecodeFunction& decode, uint workers = 1);
+	// Blocks that start at the given offsets, in increasing order, the first one at 0.
+	void Start(const std::vector<u64>& blockStarts, u64 imageSize, const DecodeFunction& decode, uint workers = 1);
+	void Stop();
+
+	// Copies from the block that contains offset, up to its end.  Returns the number of bytes
+	// copied, 0 past the end of the image, or -1 if the block couldn't be decompressed.
+	int Read(void* pDest, u64 offset, int length);
+
+	// Starts decompressing the blocks that hold the range without waiting for them.
+	void Prefetch(u64 offset, int length);
+
+private:
+	static const u32 NoBlock = 0xFFFFFFFF;
+
+	void StartWorkers(const DecodeFunction& decode, uint workers);
+	void ThreadProc(uint worker);
+	void Schedule(u32 block);
+	u32 NextBlock();
+	u32 BlockOf(u64 offset) const;
+	u64 BlockStart(u32 block) const;
+	u32 BlockSize(u32 block) const { return (u32)(BlockStart(block + 1) - BlockStart(block)); }
+	bool IsCached(u32 block) const;
+	bool IsBusy(u32 block) const;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_lock;
+	std::condition_variable m_work;
+	std::condition_variable m_done;
+
+	ChunksCache m_cache;
+	uint m_cacheLimitMb;
+	DecodeFunction m_decode;
+
+	u64 m_imageSize;
+	std::vector<u64> m_blockStarts; // empty when all the blocks are m_blockSize
+	u32 m_blockSize;
+	u32 m_maxBlockSize;
+	u32 m_blockCount;
+	u32 m_aheadBlocks;
+
+	std::vector<u32> m_busy; // block each worker decompresses
+	u32 m_wantedNext;        // blocks reads are waiting for, decompressed before anything else
+	u32 m_wantedEnd;
+	u32 m_lastBlock;         // block of the previous read, to detect sequential access
+	u32 m_aheadNext;         // next block to read ahead
+	u32 m_aheadEnd;          // end of the readahead window
+	u32 m_failed;            // last block that couldn't be decompressed
+	bool m_exit;
+};
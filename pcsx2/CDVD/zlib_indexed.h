@@ -48,6 +48,7 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
   - extract: added state import/export for instant sequential access regardless of index
       (Thanks to Mark Adler for suggesting the approach)
   - build_index(...) - added progress prints
+  - build_index(...) - added a callback for each new access point, which can also abort the build
   - CHUNK changed from 16k to 512k
  */
 
@@ -223,8 +224,13 @@ local struct access* addpoint(struct access* index, int bits,
    of the first zlib or gzip stream in the file is ignored.  build_index()
    returns the number of access points on success (>= 1), Z_MEM_ERROR for out
    of memory, Z_DATA_ERROR for an error in the input file, or Z_ERRNO for a
-   file read error.  On success, *built points to the resulting index. */
-local int build_index(FILE* in, PX_off_t span, struct access** built)
+   file read error.  On success, *built points to the resulting index.
+   If given, added(ctx, index) is called after each new access point, which is
+   the last one of index->list; the build stops with Z_ERRNO if it returns 0. */
+typedef int (*index_added_cb)(void* ctx, const struct access* index);
+
+local int build_index(FILE* in, PX_off_t span, struct access** built,
+					  index_added_cb added = NULL, void* ctx = NULL)
 {
 	int ret;
 	PX_off_t totin, totout, totPrinted; /* our own total counters to avoid 4GB limit */
@@ -310,6 +316,11 @@ local int build_index(FILE* in, PX_off_t span, struct access** built)
 					goto build_index_error;
 				}
 				last = totout;
+				if (added && !added(ctx, index))
+				{
+					ret = Z_ERRNO;
+					goto build_index_error;
+				}
 			}
 		} while (strm.avail_in != 0);
 		if (totin / (50 * 1024 * 1024) != totPrinted / (50 * 1024 * 1024))
@@ -28,6 +28,7 @@
 
 #include "GS.h"
 #include "VUmicro.h"
+#include "MTVU.h"
 
 #include "ps2/HwInternal.h"
 
@@ -414,6 +415,7 @@ static __fi void VSyncStart(u32 sCycle)
 
 	CpuVU0->Vsync();
 	CpuVU1->Vsync();
+	if (THREAD_VU1) vu1Thread.Vsync();
 
 	hwIntcIrq(INTC_VBLANK_S);
 	psxVBlankStart();
@@ -0,0 +1,194 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GuestProfiler.h"
+#include "SymbolMap.h"
+#include "R5900.h"
+#include "R3000A.h"
+#include "VU.h"
+#include "System/SysThreads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace GuestProfiler
+{
+	enum ProfiledCpu
+	{
+		PROF_EE,
+		PROF_IOP,
+		PROF_VU1,
+
+		PROF_COUNT
+	};
+
+	static const char* const s_cpuNames[PROF_COUNT] = {"EE", "IOP", "VU1"};
+
+	// Sample counts keyed by guest pc, one map per cpu
+	typedef std::unordered_map<u32, u32> PcHistogram;
+
+	static std::thread s_thread;
+	static std::atomic<bool> s_running(false);
+	static std::mutex s_lock;
+	static PcHistogram s_samples[PROF_COUNT];
+	static u32 s_total;
+
+	// The registers are owned by other threads; a torn or stale pc only
+	// misattributes one sample, so they are read without synchronization.
+	static __fi u32 ReadPc(const u32& pc)
+	{
+		return *(const volatile u32*)&pc;
+	}
+
+	static void SampleLoop(u32 hz)
+	{
+		const auto period = std::chrono::microseconds(1000000 / hz);
+		auto next = std::chrono::steady_clock::now();
+
+		while (s_running.load(std::memory_order_relaxed))
+		{
+			next += period;
+			std::this_thread::sleep_until(next);
+
+			// A paused or stopped core leaves its registers frozen; sampling them would
+			// pile idle time onto whatever pc the cpus last stopped at.
+			if (GetCoreThread().GetExecutionMode() != SysThreadBase::ExecMode_Opened)
+				continue;
+
+			const u32 eePc = ReadPc(cpuRegs.pc);
+			const u32 iopPc = ReadPc(psxRegs.pc);
+			const bool vu1Running = (ReadPc(VU0.VI[REG_VPU_STAT].UL) & 0x100) != 0;
+			const u32 vu1Pc = ReadPc(VU1.VI[REG_TPC].UL);
+
+			std::lock_guard<std::mutex> guard(s_lock);
+			s_samples[PROF_EE][eePc]++;
+			s_samples[PROF_IOP][iopPc]++;
+			if (vu1Running)
+				s_samples[PROF_VU1][vu1Pc]++;
+			s_total++;
+		}
+	}
+
+	bool Start(u32 hz)
+	{
+		if (s_running || hz == 0)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> guard(s_lock);
+			for (auto& samples : s_samples)
+				samples.clear();
+			s_total = 0;
+		}
+
+		s_running = true;
+		s_thread = std::thread(SampleLoop, std::min<u32>(hz, 100000));
+		return true;
+	}
+
+	void Stop()
+	{
+		if (!s_running)
+			return;
+
+		s_running = false;
+		s_thread.join();
+	}
+
+	bool IsRunning()
+	{
+		return s_running;
+	}
+
+	static std::string FunctionName(int cpu, u32 pc)
+	{
+		char name[32];
+
+		if (cpu == PROF_EE)
+		{
+			const u32 start = symbolMap.GetFunctionStart(pc);
+			if (start != SymbolMap::INVALID_ADDRESS)
+			{
+				std::string label = symbolMap.GetLabelString(start);
+				if (!label.empty())
+				{
+					// ';' separates frames in the collapsed format
+					std::replace(label.begin(), label.end(), ';', ':');
+					return label;
+				}
+
+				snprintf(name, sizeof(name), "(%08x)", start);
+				return name;
+			}
+		}
+
+		snprintf(name, sizeof(name), cpu == PROF_VU1 ? "(%04x)" : "(%08x)", pc);
+		return name;
+	}
+
+	bool Dump(const char* filename)
+	{
+		PcHistogram samples[PROF_COUNT];
+		u32 total;
+
+		{
+			std::lock_guard<std::mutex> guard(s_lock);
+			for (int cpu = 0; cpu < PROF_COUNT; cpu++)
+				samples[cpu] = s_samples[cpu];
+			total = s_total;
+		}
+
+		FILE* fp = fopen(filename, "w");
+		if (!fp)
+		{
+			log_cb(RETRO_LOG_ERROR, "GuestProfiler: can't open %s for writing\n", filename);
+			return false;
+		}
+
+		log_cb(RETRO_LOG_INFO, "GuestProfiler: %u samples written to %s\n", total, filename);
+
+		for (int cpu = 0; cpu < PROF_COUNT; cpu++)
+		{
+			std::unordered_map<std::string, u32> functions;
+			for (const auto& it : samples[cpu])
+				functions[FunctionName(cpu, it.first)] += it.second;
+
+			std::vector<std::pair<std::string, u32>> sorted(functions.begin(), functions.end());
+			std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, u32>& a, const std::pair<std::string, u32>& b) {
+				return a.second > b.second;
+			});
+
+			for (const auto& it : sorted)
+				fprintf(fp, "%s;%s %u\n", s_cpuNames[cpu], it.first.c_str(), it.second);
+
+			const size_t top = std::min<size_t>(sorted.size(), 5);
+			for (size_t i = 0; i < top; i++)
+			{
+				log_cb(RETRO_LOG_INFO, "GuestProfiler: %-3s %5.1f%% %s\n", s_cpuNames[cpu],
+					100.0 * sorted[i].second / total, sorted[i].first.c_str());
+			}
+		}
+
+		fclose(fp);
+		return true;
+	}
+}
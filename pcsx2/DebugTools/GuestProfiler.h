@@ -0,0 +1,40 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Pcsx2Types.h"
+
+// Sampling profiler for guest code.
+//
+// While running, a host thread wakes up at a fixed rate and records the
+// current EE and IOP program counters, plus the VU1 program counter when a
+// microprogram is running. Nothing is added to the emulation threads, so the
+// cost is a few loads per sample. The PCs are the ones the recompilers last
+// stored back to the register files, which is at block granularity; that's
+// precise enough to attribute time to functions.
+//
+// Samples are aggregated per function at dump time, using the symbolMap for
+// the EE and raw addresses for the IOP and VU1, and written in the collapsed
+// stack format used by flamegraph.pl ("EE;function count" per line).
+namespace GuestProfiler
+{
+	bool Start(u32 hz);
+	void Stop();
+	bool IsRunning();
+
+	// Writes the samples gathered since Start. Can be called while running.
+	bool Dump(const char* filename);
+}
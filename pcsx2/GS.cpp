@@ -402,3 +402,17 @@ void SaveStateBase::gsFreeze()
 	FreezeMem(PS2MEM_GS, 0x2000);
 	Freeze(gsVideoMode);
 }
+
+// Plugin-side GS state goes through the MTGS ring so that it's taken in order with the
+// packets queued before it.  On libretro the frontend thread *is* the MTGS thread, in
+// which case the ring has already been serviced by the caller and GSfreeze can be
+// invoked directly.
+s32 gsSafeFreeze( int mode, freezeData *data )
+{
+	if (GetMTGS().IsSelf())
+		return GSfreeze( mode, data );
+
+	MTGS_FreezeData sstate = { data, 0 };
+	GetMTGS().Freeze( mode, sstate );
+	return sstate.retval;
+}
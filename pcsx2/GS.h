@@ -354,6 +354,12 @@ public:
 	uint			m_packet_size;		// size of the packet (data only, ie. not including the 16 byte command!)
 	uint			m_packet_writepos;	// index of the data location in the ringbuffer.
 
+#ifdef __LIBRETRO__
+	// Set while DrainRingInThread is running: ExecuteTaskInThread returns as soon as the
+	// ring is empty instead of waiting for the next vsync.
+	bool			m_DrainRing;
+#endif
+
 #ifdef RINGBUF_DEBUG_STACK
 	Threading::Mutex m_lock_Stack;
 #endif
@@ -385,6 +391,9 @@ public:
 
 	void ExecuteTaskInThread();
 	void FinishTaskInThread();
+#ifdef __LIBRETRO__
+	void DrainRingInThread();
+#endif
 	void OpenGS();
 	void CloseGS();
 
@@ -20,6 +20,7 @@
 #include "yaml-cpp/yaml.h"
 #include <algorithm>
 #include <cctype>
+#include <iterator>
 
 std::string strToLower(std::string str)
 {
@@ -185,14 +186,43 @@ GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::entryFromYaml(const std::str
 	return gameEntry;
 }
 
+GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::entryFromIndex(const IndexEntry& entry)
+{
+	try
+	{
+		YAML::Node data = YAML::Load(std::string(entry.text, entry.length));
+		if (data.IsMap() && data.size() == 1)
+			return entryFromYaml(entry.serial, data.begin()->second);
+
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid GameDB syntax detected on serial: '%s'. Expected a single entry\n", entry.serial.c_str());
+	} catch (const std::exception& e)
+	{
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid GameDB syntax detected on serial: '%s'. Error Details - %s\n", entry.serial.c_str(), e.what());
+	}
+
+	GameDatabaseSchema::GameEntry gameEntry;
+	gameEntry.isValid = false;
+	return gameEntry;
+}
+
 GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::findGame(const std::string serial)
 {
 	std::string serialLower = strToLower(serial);
 	log_cb(RETRO_LOG_INFO, "[GameDB] Searching for '%s' in GameDB\n", serialLower.c_str());
-	if (gameDb.count(serialLower) == 1)
+
+	auto cached = gameDb.find(serialLower);
+	if (cached != gameDb.end())
+	{
+		log_cb(RETRO_LOG_INFO, "[GameDB] Found '%s' in GameDB\n", serialLower.c_str());
+		return cached->second;
+	}
+
+	auto it = std::lower_bound(index.begin(), index.end(), serialLower,
+		[](const IndexEntry& entry, const std::string& key) { return entry.serial < key; });
+	if (it != index.end() && it->serial == serialLower)
 	{
 		log_cb(RETRO_LOG_INFO, "[GameDB] Found '%s' in GameDB\n", serialLower.c_str());
-		return gameDb[serialLower];
+		return gameDb[serialLower] = entryFromIndex(*it);
 	}
 
 	log_cb(RETRO_LOG_ERROR, "[GameDB] Could not find '%s' in GameDB\n", serialLower.c_str());
@@ -203,48 +233,73 @@ GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::findGame(const std::string s
 
 int YamlGameDatabaseImpl::numGames()
 {
-	return gameDb.size();
+	return index.size();
 }
 
 bool YamlGameDatabaseImpl::initDatabase(std::istream& stream)
 {
-	try
+	if (!stream)
 	{
-		if (!stream)
-		{
-			log_cb(RETRO_LOG_ERROR, "[GameDB] Unable to open GameDB file.\n");
-			return false;
-		}
-		// yaml-cpp has memory leak issues if you persist and modify a YAML::Node
-		// convert to a map and throw it away instead!
-		YAML::Node data = YAML::Load(stream);
-		for (const auto& entry : data)
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Unable to open GameDB file.\n");
+		return false;
+	}
+
+	ownedData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return initDatabase(ownedData.data(), ownedData.size());
+}
+
+bool YamlGameDatabaseImpl::initDatabase(const char* data, size_t size)
+{
+	index.clear();
+	gameDb.clear();
+
+	// Every line that isn't indented, blank or a comment is the key of a new
+	// entry, and the entry runs until the next one.
+	const char* end = data + size;
+	for (const char* line = data; line < end;)
+	{
+		const char* eol = std::find(line, end, '\n');
+
+		if (*line != ' ' && *line != '\t' && *line != '#' && *line != '\n' && *line != '\r')
 		{
-			// we don't want to throw away the entire GameDB file if a single entry is made incorrectly,
-			// but we do want to yell about it so it can be corrected
-			try
+			const char* colon = std::find(line, eol, ':');
+			if (colon == eol)
 			{
-				// Serials and CRCs must be inserted as lower-case, as that is how they are retrieved
-				// this is because the application may pass a lowercase CRC or serial along
-				//
-				// However, YAML's keys are as expected case-sensitive, so we have to explicitly do our own duplicate checking
-				std::string serial = strToLower(entry.first.as<std::string>());
-				if (gameDb.count(serial) == 1)
-				{
-					log_cb(RETRO_LOG_ERROR, "[GameDB] Duplicate serial '%s' found in GameDB. Skipping, Serials are case-insensitive!\n", serial.c_str());
-					continue;
-				}
-				gameDb[serial] = entryFromYaml(serial, entry.second);
-			} catch (const YAML::RepresentationException& e)
+				log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid GameDB syntax detected. Unexpected line: '%s'\n", std::string(line, eol).c_str());
+			} else
 			{
-				log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid GameDB syntax detected. Error Details - %s\n", e.msg.c_str());
+				if (!index.empty())
+					index.back().length = line - index.back().text;
+
+				// Serials are looked up lower-case, as the application may pass them that way
+				IndexEntry entry = { strToLower(std::string(line, colon)), line, 0 };
+				index.push_back(std::move(entry));
 			}
 		}
-	} catch (const std::exception& e)
+
+		line = eol < end ? eol + 1 : end;
+	}
+
+	if (!index.empty())
+		index.back().length = end - index.back().text;
+
+	std::stable_sort(index.begin(), index.end(),
+		[](const IndexEntry& a, const IndexEntry& b) { return a.serial < b.serial; });
+
+	// YAML's keys are case-sensitive, so we have to explicitly do our own duplicate checking
+	size_t kept = 0;
+	for (size_t i = 0; i < index.size(); i++)
 	{
-		log_cb(RETRO_LOG_ERROR, "[GameDB] Error occured when initializing GameDB: %s\n", e.what());
-		return false;
+		if (kept && index[kept - 1].serial == index[i].serial)
+		{
+			log_cb(RETRO_LOG_ERROR, "[GameDB] Duplicate serial '%s' found in GameDB. Skipping, Serials are case-insensitive!\n", index[i].serial.c_str());
+			continue;
+		}
+		if (kept != i)
+			index[kept] = std::move(index[i]);
+		kept++;
 	}
+	index.resize(kept);
 
 	return true;
 }
@@ -91,15 +91,30 @@ public:
 	virtual int numGames() = 0;
 };
 
+// Only the top level serial keys are indexed when the database is loaded,
+// an entry's YAML is parsed the first time its serial is looked up.
 class YamlGameDatabaseImpl : public IGameDatabase
 {
 public:
 	bool initDatabase(std::istream& stream) override;
+	// Indexes a YAML document in memory without copying it, data has to
+	// outlive the database.
+	bool initDatabase(const char* data, size_t size);
 	GameDatabaseSchema::GameEntry findGame(const std::string serial) override;
 	int numGames() override;
 
 private:
-	std::unordered_map<std::string, GameDatabaseSchema::GameEntry> gameDb;
+	struct IndexEntry
+	{
+		std::string serial; // lower-case
+		const char* text;   // the entry's YAML, key included
+		size_t length;
+	};
+
+	std::string ownedData;          // document read from a stream
+	std::vector<IndexEntry> index;  // sorted by serial
+	std::unordered_map<std::string, GameDatabaseSchema::GameEntry> gameDb; // entries parsed so far
+	GameDatabaseSchema::GameEntry entryFromIndex(const IndexEntry& entry);
 	GameDatabaseSchema::GameEntry entryFromYaml(const std::string serial, const YAML::Node& node);
 
 	std::vector<std::string> convertMultiLineStringToVector(const std::string multiLineString);
@@ -18,6 +18,7 @@
 
 #include "IPU.h"
 #include "IPUdma.h"
+#include "IPUthread.h"
 #include "yuv2rgb.h"
 #include "mpeg2lib/Mpeg.h"
 
@@ -77,6 +78,8 @@ __fi void IPUProcessInterrupt()
 
 void ipuReset()
 {
+	ipuThreadCancel();
+
 	memzero(ipuRegs);
 	memzero(g_BP);
 	memzero(decoder);
@@ -91,6 +94,7 @@ void SaveStateBase::ipuFreeze()
 {
 	// Get a report of the status of the ipu variables when saving and loading savestates.
 	FreezeTag("IPU");
+	ipuThreadCancel();
 	Freeze(ipu_fifo);
 
 	Freeze(g_BP);
@@ -117,6 +121,7 @@ __fi u32 ipuRead32(u32 mem)
 		{
 			if (ipu_cmd.CMD != SCE_IPU_FDEC && ipu_cmd.CMD != SCE_IPU_VDEC)
 			{
+				ipuThreadCancel();
 				if (getBits32((u8*)&ipuRegs.cmd.DATA, 0))
 					ipuRegs.cmd.DATA = BigEndian(ipuRegs.cmd.DATA);
 			}
@@ -125,7 +130,7 @@ __fi u32 ipuRead32(u32 mem)
 
 		ipucase(IPU_CTRL): // IPU_CTRL
 		{
-			ipuRegs.ctrl.IFC = g_BP.IFC;
+			ipuRegs.ctrl.IFC = ipuThreadBP().IFC;
 			ipuRegs.ctrl.CBP = coded_block_pattern;
 
 #ifndef NDEBUG
@@ -138,11 +143,12 @@ __fi u32 ipuRead32(u32 mem)
 
 		ipucase(IPU_BP): // IPU_BP
 		{
-			pxAssume(g_BP.FP <= 2);
+			const tIPU_BP& bp = ipuThreadBP();
+			pxAssume(bp.FP <= 2);
 			
-			ipuRegs.ipubp = g_BP.BP & 0x7f;
-			ipuRegs.ipubp |= g_BP.IFC << 8;
-			ipuRegs.ipubp |= g_BP.FP << 16;
+			ipuRegs.ipubp = bp.BP & 0x7f;
+			ipuRegs.ipubp |= bp.IFC << 8;
+			ipuRegs.ipubp |= bp.FP << 16;
 
 			IPU_LOG("read32: IPU_BP=0x%08X", ipuRegs.ipubp);
 			return ipuRegs.ipubp;
@@ -171,6 +177,7 @@ __fi u64 ipuRead64(u32 mem)
 		{
 			if (ipu_cmd.CMD != SCE_IPU_FDEC && ipu_cmd.CMD != SCE_IPU_VDEC)
 			{
+				ipuThreadCancel();
 				if (getBits32((u8*)&ipuRegs.cmd.DATA, 0))
 					ipuRegs.cmd.DATA = BigEndian(ipuRegs.cmd.DATA);
 			}
@@ -196,7 +203,7 @@ __fi u64 ipuRead64(u32 mem)
 
 		ipucase(IPU_TOP): // IPU_TOP
 #ifndef NDEBUG
-			IPU_LOG("read64: IPU_TOP=%x,  bp = %d", ipuRegs.top, g_BP.BP);
+			IPU_LOG("read64: IPU_TOP=%x,  bp = %d", ipuRegs.top, ipuThreadBP().BP);
 #endif
 			break;
 
@@ -211,6 +218,7 @@ __fi u64 ipuRead64(u32 mem)
 
 void ipuSoftReset()
 {
+	ipuThreadCancel();
 	ipu_fifo.clear();
 
 	coded_block_pattern = 0;
@@ -612,6 +620,7 @@ __fi void ipu_csc(macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn)
 	}
 	if (sgn)
 	{
+		p = (u8*)&rgb32;
 		for (i = 0; i < 16*16; i++, p += 4)
 		{
 			*(u32*)p ^= 0x808080;
@@ -782,6 +791,7 @@ __fi void IPUCMD_WRITE(u32 val)
 {
 	// don't process anything if currently busy
 	//if (ipuRegs.ctrl.BUSY) log_cb(RETRO_LOG_WARN, "IPU BUSY!\n"); // wait for thread
+	ipuThreadCancel();
 
 	ipuRegs.ctrl.ECD = 0;
 	ipuRegs.ctrl.SCD = 0;
@@ -865,7 +875,14 @@ __noinline void IPUWorker()
 			//break;
 
 		case SCE_IPU_IDEC:
-			if (!mpeg2sliceIDEC()) return;
+			// The next macroblock is collected once the one held back has drained.
+			if (ipuThreadPending() && !ipuThreadDrainIDEC()) return;
+
+			if (!mpeg2sliceIDEC())
+			{
+				ipuThreadStartIDEC();
+				return;
+			}
 
 			//ipuRegs.ctrl.OFC = 0;
 			ipuRegs.topbusy = 0;
@@ -17,6 +17,7 @@
 #include "Common.h"
 #include "IPU.h"
 #include "IPU/IPUdma.h"
+#include "IPU/IPUthread.h"
 #include "mpeg2lib/Mpeg.h"
 
 __aligned16 IPU_Fifo ipu_fifo;
@@ -56,6 +57,8 @@ void IPU_Fifo::clear()
 
 int IPU_Fifo_Input::write(u32* pMem, int size)
 {
+	ipuThreadCancel();
+
 	int transsize;
 	int firsttrans = std::min(size, 8 - (int)g_BP.IFC);
 
@@ -78,7 +81,10 @@ int IPU_Fifo_Input::read(void *value)
 	if (g_BP.IFC < 3)
 	{
 		// IPU FIFO is empty and DMA is waiting so lets tell the DMA we are ready to put data in the FIFO
-		if(cpuRegs.eCycle[4] == 0x9999)
+		// (the worker leaves that to the EE, which does it when collecting the macroblock)
+		if (ipuThreadAhead)
+			ipuThreadStarved = true;
+		else if(cpuRegs.eCycle[4] == 0x9999)
 		{
 			CPU_INT( DMAC_TO_IPU, 32 );
 		}
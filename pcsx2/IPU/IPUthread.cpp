@@ -0,0 +1,203 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "IPU.h"
+#include "IPUthread.h"
+#include "mpeg2lib/Mpeg.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Resumable decoder state private to Mpeg.cpp
+struct DCTtab;
+extern const DCTtab* tab;
+extern int mbaCount;
+
+thread_local bool ipuThreadAhead = false;
+bool ipuThreadStarved = false;
+
+// Everything the worker may change, as the serial decoder left it. The EE drains the
+// held macroblock out of this copy of the decoder while the worker overwrites the live one.
+struct IPUHeldState
+{
+	tIPU_BP bp;
+	IPU_Fifo_Input in;
+	tIPU_cmd cmd;
+	decoder_t decoder;
+	const DCTtab* tab;
+	int mbaCount;
+};
+
+static __aligned16 IPUHeldState s_held;
+static bool s_pending = false; // EE side: the worker owns the decode state
+
+static std::atomic<bool> s_enabled(false);
+static std::thread s_thread;
+static std::mutex s_lock;
+static std::condition_variable s_cond;
+static bool s_job = false;
+static bool s_done = false;
+static bool s_quit = false;
+static bool s_ready = false; // the worker left a whole macroblock in decoder
+
+static void AheadLoop()
+{
+	std::unique_lock<std::mutex> lock(s_lock);
+
+	while (true)
+	{
+		s_cond.wait(lock, [] { return s_job || s_quit; });
+		if (!s_job)
+			break;
+
+		s_job = false;
+		lock.unlock();
+
+		ipuThreadAhead = true;
+		ipuThreadStarved = false;
+		mpeg2sliceIDEC();
+		s_ready = ipu_cmd.pos[1] == 2 && decoder.ipu0_data > 0;
+		ipuThreadAhead = false;
+
+		lock.lock();
+		s_done = true;
+		s_cond.notify_all();
+	}
+}
+
+static void WaitAhead()
+{
+	std::unique_lock<std::mutex> lock(s_lock);
+	s_cond.wait(lock, [] { return s_done; });
+	s_pending = false;
+}
+
+static void RestoreHeld()
+{
+	g_BP = s_held.bp;
+	ipu_fifo.in = s_held.in;
+	ipu_cmd = s_held.cmd;
+	decoder = s_held.decoder;
+	tab = s_held.tab;
+	mbaCount = s_held.mbaCount;
+}
+
+void ipuThreadSetEnabled(bool enabled)
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ipuThreadShutdown()
+{
+	if (!s_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+		s_quit = true;
+	}
+	s_cond.notify_all();
+	s_thread.join();
+}
+
+bool ipuThreadPending()
+{
+	return s_pending;
+}
+
+// Called after mpeg2sliceIDEC() gave up. Only a macroblock stuck on a full output FIFO
+// is handed over; when the decoder is short of input, the worker would be too.
+void ipuThreadStartIDEC()
+{
+	if (!s_enabled.load(std::memory_order_relaxed))
+		return;
+	if (ipu_cmd.pos[0] != 2 || ipu_cmd.pos[1] != 2)
+		return;
+
+	if (!s_thread.joinable())
+	{
+		s_quit = false;
+		s_thread = std::thread(AheadLoop);
+	}
+
+	s_held.bp = g_BP;
+	s_held.in = ipu_fifo.in;
+	s_held.cmd = ipu_cmd;
+	s_held.decoder = decoder;
+	s_held.tab = tab;
+	s_held.mbaCount = mbaCount;
+
+	// Start the worker where the serial decoder goes once the write has gone through:
+	// at the address increment of the next macroblock.
+	decoder.ipu0_data = 0;
+	ipu_cmd.pos[1] = 3;
+	mbaCount = 0;
+
+	s_pending = true;
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+		s_done = false;
+		s_job = true;
+	}
+	s_cond.notify_all();
+}
+
+// Feeds the held macroblock to the output FIFO. Returns true once it's all written and the
+// decode state is back with the EE, holding either the next macroblock or the serial state.
+bool ipuThreadDrainIDEC()
+{
+	decoder_t& held = s_held.decoder;
+
+	uint read = ipu_fifo.out.write((u32*)held.GetIpuDataPtr(), held.ipu0_data);
+	held.AdvanceIpuDataBy(read);
+
+	if (held.ipu0_data != 0)
+		return false;
+
+	WaitAhead();
+
+	if (!s_ready)
+	{
+		// Out of input, or the end of the slice; neither may be acted on ahead of time.
+		RestoreHeld();
+		ipu_cmd.pos[1] = 3;
+		mbaCount = 0;
+		return true;
+	}
+
+	// The serial decoder would have asked the DMA for more input while it decoded.
+	if (ipuThreadStarved && cpuRegs.eCycle[4] == 0x9999)
+		CPU_INT(DMAC_TO_IPU, 32);
+
+	return true;
+}
+
+void ipuThreadCancel()
+{
+	if (!s_pending)
+		return;
+
+	WaitAhead();
+	RestoreHeld();
+}
+
+const tIPU_BP& ipuThreadBP()
+{
+	return s_pending ? s_held.bp : g_BP;
+}
@@ -0,0 +1,44 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+struct tIPU_BP;
+
+// Run-ahead decoding of IDEC macroblocks on a host thread.
+//
+// An IDEC macroblock that doesn't fit in the output FIFO normally parks the decoder
+// until the IPU0 DMA has drained it. With run-ahead enabled, the pending output is
+// set aside for the EE to drain while the worker decodes and colour converts the next
+// macroblock. The worker owns the decode state (g_BP, the input FIFO, decoder and
+// ipu_cmd) until the EE collects it, so every EE path that touches that state calls
+// ipuThreadCancel() first; it waits for the worker and puts the state back where the
+// serial decoder left it. The guest only ever sees the serial results.
+
+// Set on the worker while it decodes; the decoder must not touch EE state then.
+extern thread_local bool ipuThreadAhead;
+// The worker read from an input FIFO holding fewer than 3 QWC.
+extern bool ipuThreadStarved;
+
+extern void ipuThreadSetEnabled(bool enabled);
+extern void ipuThreadShutdown();
+
+extern bool ipuThreadPending();
+extern void ipuThreadStartIDEC();
+extern bool ipuThreadDrainIDEC();
+extern void ipuThreadCancel();
+
+// The bitstream state the guest sees, while a macroblock is decoded ahead or not.
+extern const tIPU_BP& ipuThreadBP();
@@ -22,10 +22,6 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-// [TODO] : There are modern SSE versions of idct (idct_mmx.c) in the mpeg2 libs that we
-// should probably upgrade to.  They use their own raw-style intrinsics and not the intel
-// compiler-integrated ones.
-
 #include "PrecompiledHeader.h"
 
 #include "Common.h"
@@ -40,146 +36,170 @@
 #define W7 565  /* 2048*sqrt (2)*cos (7*pi/16) */
 
 /*
- * In legal streams, the IDCT output should be between -384 and +384.
- * In corrupted streams, it is possible to force the IDCT output to go
- * to +-3826 - this is the worst case for a column IDCT where the
- * column inputs are 16-bit values.
+ * SSE2 version of the mpeg2dec integer IDCT.  All eight rows (then all eight
+ * columns) are transformed at once, with the arithmetic of the scalar code
+ * kept exactly: 32-bit intermediates, the same rounding constants and
+ * shifts, and row results truncated to 16 bits.  The output is bit for bit
+ * the one of the original C version.
  */
-static __aligned16 u8 clip_lut[1024];
 
-#define CLIP(i) ((clip_lut+384)[(i)])
+// The two products of a butterfly are done by pmaddwd on interleaved
+// (d0, d1) pairs: w0*d0 + w1*d1 is exactly what BUTTERFLY computes.
+static __fi __m128i wpair(int w0, int w1)
+{
+	return _mm_set1_epi32((w1 << 16) | (u16)w0);
+}
 
-static __fi void BUTTERFLY(int& t0, int& t1, int w0, int w1, int d0, int d1)
+static __fi __m128i widen(__m128i x, bool hi)
 {
-#if 0
-    t0 = w0*d0 + w1*d1;
-    t1 = w0*d1 - w1*d0;
-#else
-    int tmp = w0 * (d0 + d1);
-    t0 = tmp + (w1 - w0) * d1;
-    t1 = tmp - (w1 + w0) * d0;
-#endif
+	x = hi ? _mm_unpackhi_epi16(x, x) : _mm_unpacklo_epi16(x, x);
+	return _mm_srai_epi32(x, 16);
 }
 
-static __fi void idct_row (s16 * const block)
+static __fi __m128i interleave(__m128i a, __m128i b, bool hi)
 {
-    int d0, d1, d2, d3;
-    int a0, a1, a2, a3, b0, b1, b2, b3;
-    int t0, t1, t2, t3;
-
-    /* shortcut */
-    if (!(block[1] | ((s32 *)block)[1] | ((s32 *)block)[2] |
-		  ((s32 *)block)[3])) {
-		u32 tmp = (u16) (block[0] << 3);
-		tmp |= tmp << 16;
-		((s32 *)block)[0] = tmp;
-		((s32 *)block)[1] = tmp;
-		((s32 *)block)[2] = tmp;
-		((s32 *)block)[3] = tmp;
-		return;
-    }
+	return hi ? _mm_unpackhi_epi16(a, b) : _mm_unpacklo_epi16(a, b);
+}
+
+// x * 181, wrapping like the 32-bit multiply of the scalar code
+static __fi __m128i mul181(__m128i x)
+{
+	__m128i r = _mm_add_epi32(x, _mm_slli_epi32(x, 2));
+	r = _mm_add_epi32(r, _mm_slli_epi32(x, 4));
+	r = _mm_add_epi32(r, _mm_slli_epi32(x, 5));
+	return _mm_add_epi32(r, _mm_slli_epi32(x, 7));
+}
+
+// One 1D pass over four lanes.  col selects the column pass constants.
+template< bool col >
+static __fi void idct_half(const __m128i* v, __m128i* out, bool hi)
+{
+	__m128i a0, a1, a2, a3, b0, b1, b2, b3;
+	__m128i t0, t1, t2, t3, p;
+
+	__m128i d0 = _mm_add_epi32(_mm_slli_epi32(widen(v[0], hi), 11), _mm_set1_epi32(col ? 65536 : 128));
+	__m128i d2 = _mm_slli_epi32(widen(v[2], hi), 11);
+	t0 = _mm_add_epi32(d0, d2);
+	t1 = _mm_sub_epi32(d0, d2);
+	p = interleave(v[3], v[1], hi);
+	t2 = _mm_madd_epi16(p, wpair(W6, W2));
+	t3 = _mm_madd_epi16(p, wpair(-W2, W6));
+	a0 = _mm_add_epi32(t0, t2);
+	a1 = _mm_add_epi32(t1, t3);
+	a2 = _mm_sub_epi32(t1, t3);
+	a3 = _mm_sub_epi32(t0, t2);
+
+	p = interleave(v[7], v[4], hi);
+	t0 = _mm_madd_epi16(p, wpair(W7, W1));
+	t1 = _mm_madd_epi16(p, wpair(-W1, W7));
+	p = interleave(v[5], v[6], hi);
+	t2 = _mm_madd_epi16(p, wpair(W3, W5));
+	t3 = _mm_madd_epi16(p, wpair(-W5, W3));
+	b0 = _mm_add_epi32(t0, t2);
+	b3 = _mm_add_epi32(t1, t3);
+	t0 = _mm_sub_epi32(t0, t2);
+	t1 = _mm_sub_epi32(t1, t3);
+
+	if (col) {
+		t0 = _mm_srai_epi32(t0, 8);
+		t1 = _mm_srai_epi32(t1, 8);
+		b1 = mul181(_mm_add_epi32(t0, t1));
+		b2 = mul181(_mm_sub_epi32(t0, t1));
+	}
+	else {
+		b1 = _mm_srai_epi32(mul181(_mm_add_epi32(t0, t1)), 8);
+		b2 = _mm_srai_epi32(mul181(_mm_sub_epi32(t0, t1)), 8);
+	}
+
+	const int shift = col ? 17 : 8;
+	out[0] = _mm_srai_epi32(_mm_add_epi32(a0, b0), shift);
+	out[1] = _mm_srai_epi32(_mm_add_epi32(a1, b1), shift);
+	out[2] = _mm_srai_epi32(_mm_add_epi32(a2, b2), shift);
+	out[3] = _mm_srai_epi32(_mm_add_epi32(a3, b3), shift);
+	out[4] = _mm_srai_epi32(_mm_sub_epi32(a3, b3), shift);
+	out[5] = _mm_srai_epi32(_mm_sub_epi32(a2, b2), shift);
+	out[6] = _mm_srai_epi32(_mm_sub_epi32(a1, b1), shift);
+	out[7] = _mm_srai_epi32(_mm_sub_epi32(a0, b0), shift);
+}
+
+// Narrows to 16 bits by truncation, as the stores of the scalar code did.
+static __fi __m128i narrow(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+// v[k] holds coefficient k of eight independent transforms.
+template< bool col >
+static __fi void idct_pass(__m128i* v)
+{
+	__m128i lo[8], hi[8];
 
-    d0 = (block[0] << 11) + 128;
-    d1 = block[1];
-    d2 = block[2] << 11;
-    d3 = block[3];
-    t0 = d0 + d2;
-    t1 = d0 - d2;
-    BUTTERFLY (t2, t3, W6, W2, d3, d1);
-    a0 = t0 + t2;
-    a1 = t1 + t3;
-    a2 = t1 - t3;
-    a3 = t0 - t2;
-
-    d0 = block[4];
-    d1 = block[5];
-    d2 = block[6];
-    d3 = block[7];
-    BUTTERFLY (t0, t1, W7, W1, d3, d0);
-    BUTTERFLY (t2, t3, W3, W5, d1, d2);
-    b0 = t0 + t2;
-    b3 = t1 + t3;
-    t0 -= t2;
-    t1 -= t3;
-    b1 = ((t0 + t1) * 181) >> 8;
-    b2 = ((t0 - t1) * 181) >> 8;
-
-    block[0] = (a0 + b0) >> 8;
-    block[1] = (a1 + b1) >> 8;
-    block[2] = (a2 + b2) >> 8;
-    block[3] = (a3 + b3) >> 8;
-    block[4] = (a3 - b3) >> 8;
-    block[5] = (a2 - b2) >> 8;
-    block[6] = (a1 - b1) >> 8;
-    block[7] = (a0 - b0) >> 8;
+	idct_half<col>(v, lo, false);
+	idct_half<col>(v, hi, true);
+
+	for (int i = 0; i < 8; i++)
+		v[i] = narrow(lo[i], hi[i]);
 }
 
-static __fi void idct_col (s16 * const block)
+static __fi void transpose(__m128i* r)
 {
-    int d0, d1, d2, d3;
-    int a0, a1, a2, a3, b0, b1, b2, b3;
-    int t0, t1, t2, t3;
-
-    d0 = (block[8*0] << 11) + 65536;
-    d1 = block[8*1];
-    d2 = block[8*2] << 11;
-    d3 = block[8*3];
-    t0 = d0 + d2;
-    t1 = d0 - d2;
-    BUTTERFLY (t2, t3, W6, W2, d3, d1);
-    a0 = t0 + t2;
-    a1 = t1 + t3;
-    a2 = t1 - t3;
-    a3 = t0 - t2;
-
-    d0 = block[8*4];
-    d1 = block[8*5];
-    d2 = block[8*6];
-    d3 = block[8*7];
-    BUTTERFLY (t0, t1, W7, W1, d3, d0);
-    BUTTERFLY (t2, t3, W3, W5, d1, d2);
-    b0 = t0 + t2;
-    b3 = t1 + t3;
-    t0 = (t0 - t2) >> 8;
-    t1 = (t1 - t3) >> 8;
-    b1 = (t0 + t1) * 181;
-    b2 = (t0 - t1) * 181;
-
-    block[8*0] = (a0 + b0) >> 17;
-    block[8*1] = (a1 + b1) >> 17;
-    block[8*2] = (a2 + b2) >> 17;
-    block[8*3] = (a3 + b3) >> 17;
-    block[8*4] = (a3 - b3) >> 17;
-    block[8*5] = (a2 - b2) >> 17;
-    block[8*6] = (a1 - b1) >> 17;
-    block[8*7] = (a0 - b0) >> 17;
+	__m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	__m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	__m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	__m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	__m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	__m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	__m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	__m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// Transforms block into v (row i in v[i]) and clears block.
+static __fi void idct(s16 * block, __m128i* v)
+{
+	__m128i zero = _mm_setzero_si128();
+
+	for (int i = 0; i < 8; i++) {
+		v[i] = _mm_load_si128((__m128i*)block + i);
+		_mm_store_si128((__m128i*)block + i, zero);
+	}
+
+	// rows first, transposed so that each lane carries one row
+	transpose(v);
+	idct_pass<false>(v);
+	transpose(v);
+	idct_pass<true>(v);
 }
 
 __ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
 {
-    int i;
-
-    for (i = 0; i < 8; i++)
-		idct_row (block + 8 * i);
-    for (i = 0; i < 8; i++)
-		idct_col (block + i);
-
-	__m128 zero = _mm_setzero_ps();
-    do {
-		dest[0] = CLIP (block[0]);
-		dest[1] = CLIP (block[1]);
-		dest[2] = CLIP (block[2]);
-		dest[3] = CLIP (block[3]);
-		dest[4] = CLIP (block[4]);
-		dest[5] = CLIP (block[5]);
-		dest[6] = CLIP (block[6]);
-		dest[7] = CLIP (block[7]);
-
-		_mm_store_ps((float*)block, zero);
+	__m128i v[8];
+	idct(block, v);
 
+	// packuswb clamps to 0..255 like the old clip table
+	for (int i = 0; i < 8; i++) {
+		_mm_storel_epi64((__m128i*)dest, _mm_packus_epi16(v[i], v[i]));
 		dest += stride;
-		block += 8;
-    } while (--i);
+	}
 }
 
 
@@ -190,21 +210,11 @@ __ri void mpeg2_idct_add (const int last, s16 * block, s16 * dest, const int str
 
     if (last != 129 || (block[0] & 7) == 4)
     {
-		int i;
-		for (i = 0; i < 8; i++)
-			idct_row (block + 8 * i);
-		for (i = 0; i < 8; i++)
-			idct_col (block + i);
-
-		__m128 zero = _mm_setzero_ps();
-		do {
-			_mm_store_ps((float*)dest, _mm_load_ps((float*)block));
-			_mm_store_ps((float*)block, zero);
-
-			dest += stride;
-			block += 8;
-		} while (--i);
+		__m128i v[8];
+		idct(block, v);
 
+		for (int i = 0; i < 8; i++)
+			_mm_store_si128((__m128i*)(dest + stride * i), v[i]);
     }
     else
     {
@@ -237,9 +247,6 @@ mpeg2_scan_pack::mpeg2_scan_pack()
 		53, 61, 22, 30,  7, 15, 23, 31, 38, 46, 54, 62, 39, 47, 55, 63
 	};
 
-	for (int i = -384; i < 640; i++)
-		clip_lut[i+384] = (i < 0) ? 0 : ((i > 255) ? 255 : i);
-
 	for (int i = 0; i < 64; i++) {
 		int j = mpeg2_scan_norm[i];
 		norm[i] = ((j & 0x36) >> 1) | ((j & 0x09) << 2);
@@ -30,6 +30,7 @@
 
 #include "Common.h"
 #include "IPU/IPU.h"
+#include "IPU/IPUthread.h"
 #include "Mpeg.h"
 #include "Vlc.h"
 
@@ -829,6 +830,13 @@ __fi bool mpeg2sliceIDEC()
 			{
 				pxAssert(decoder.ipu0_data > 0);
 
+				// A macroblock decoded ahead stays put until the EE collects it.
+				if (ipuThreadAhead)
+				{
+					ipu_cmd.pos[1] = 2;
+					return false;
+				}
+
 				uint read = ipu_fifo.out.write((u32*)decoder.GetIpuDataPtr(), decoder.ipu0_data);
 				decoder.AdvanceIpuDataBy(read);
 
@@ -875,6 +883,10 @@ __fi bool mpeg2sliceIDEC()
 
 						default:	/* end of slice/frame, or error? */
 						{
+							// Finishing updates IPU_CTRL, which is left to the EE.
+							if (ipuThreadAhead)
+								return false;
+
 							goto finish_idec;	
 						}
 					}
@@ -69,6 +69,9 @@ void SysMtgsThread::OnStart()
 	m_RingBufferIsBusy  = false;
 	m_packet_size		= 0;
 	m_packet_writepos	= 0;
+#ifdef __LIBRETRO__
+	m_DrainRing			= false;
+#endif
 
 	m_QueuedFrameCount    = 0;
 	m_VsyncSignalListener = false;
@@ -260,7 +263,7 @@ void SysMtgsThread::ExecuteTaskInThread()
 		while (wxTheApp->HasPendingEvents())
 			wxTheApp->ProcessPendingEvents();
 
-		while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
+		while (!m_DrainRing && !m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
 		{
 			while (wxTheApp->HasPendingEvents())
 				wxTheApp->ProcessPendingEvents();
@@ -485,9 +488,30 @@ void SysMtgsThread::ExecuteTaskInThread()
 			m_sem_Vsync.Post();
 
 		//log_cb(RETRO_LOG_WARN, "(MTGS Thread) Nothing to do!  ringpos=0x%06x\n", m_ReadPos );
+#ifdef __LIBRETRO__
+		if (m_DrainRing)
+			return;
+#endif
 	}
 }
 
+#ifdef __LIBRETRO__
+// Services everything the EE has queued so far, and returns once the ring is empty rather
+// than blocking until the next vsync arrives.  Used by the savestate code, which needs the
+// GS to be in step with a paused EE before freezing it.
+void SysMtgsThread::DrainRingInThread()
+{
+	pxAssert(IsSelf());
+
+	m_DrainRing = true;
+	while (m_ReadPos.load(std::memory_order_relaxed) != m_WritePos.load(std::memory_order_acquire))
+		ExecuteTaskInThread();
+	m_DrainRing = false;
+
+	FinishTaskInThread();
+}
+#endif
+
 void SysMtgsThread::FinishTaskInThread()
 {
 	if( m_SignalRingEnable.exchange(false) )
@@ -538,6 +562,16 @@ void SysMtgsThread::OnCleanupInThread()
 // If isMTVU, then this implies this function is being called from the MTVU thread...
 void SysMtgsThread::WaitGS(bool syncRegs, bool weakWait, bool isMTVU)
 {
+#ifdef __LIBRETRO__
+	// The frontend thread doubles as the MTGS thread; waiting on ourselves would never
+	// return, so service the ring in place instead.
+	if (IsSelf())
+	{
+		DrainRingInThread();
+		if (syncRegs) memcpy(RingBuffer.Regs, PS2MEM_GS, sizeof(RingBuffer.Regs));
+		return;
+	}
+#endif
 	pxAssertDev( !IsSelf(), "This method is only allowed from threads *not* named MTGS." );
 
 	if( m_ExecMode == ExecMode_NoThreadYet || !IsRunning() ) return;
@@ -19,6 +19,8 @@
 #include "newVif.h"
 #include "Gif_Unit.h"
 
+#include <chrono>
+
 __aligned16 VU_Thread vu1Thread(CpuVU1, VU1);
 
 #define MTVU_ALWAYS_KICK 0
@@ -27,6 +29,10 @@ __aligned16 VU_Thread vu1Thread(CpuVU1, VU1);
 // Rounds up a size in bytes for size in u32's
 static __fi u32 size_u32(u32 x) { return (x + 3) >> 2; }
 
+// Bounds of the adaptive spin before the EE thread parks on semaEEWait
+static const s32 MTVU_SPIN_MIN = 16;
+static const s32 MTVU_SPIN_MAX = 4096;
+
 enum MTVU_EVENT
 {
 	MTVU_VU_EXECUTE,     // Execute VU program
@@ -34,7 +40,9 @@ enum MTVU_EVENT
 	MTVU_VU_WRITE_DATA,  // Write to VU data-mem
 	MTVU_VIF_WRITE_COL,  // Write to Vif col reg
 	MTVU_VIF_WRITE_ROW,  // Write to Vif row reg
+	MTVU_VU_CLEAR_MICRO, // Micro-mem was written in place, clear the rec cache
 	MTVU_VIF_UNPACK,     // Execute Vif Unpack
+	MTVU_VIF_UNPACK_REF, // Execute Vif Unpack on data passed by reference
 	MTVU_NULL_PACKET,    // Go back to beginning of buffer
 	MTVU_RESET
 };
@@ -111,6 +119,12 @@ void VU_Thread::Reset()
 	m_write_pos = 0;
 	m_ato_read_pos = 0;
 	m_read_pos = 0;
+	m_ato_refs_read = 0;
+	m_refs_written = 0;
+	m_ato_ee_waiting = false;
+	m_spin_budget = MTVU_SPIN_MIN;
+	memzero(m_stats);
+	memzero(m_lastStats);
 	memzero(vif);
 	memzero(vifRegs);
 	for (size_t i = 0; i < 4; ++i)
@@ -163,6 +177,13 @@ void VU_Thread::ExecuteRingBuffer()
 				Read(&vuRegs.Micro[vu_micro_addr], size);
 				break;
 			}
+			case MTVU_VU_CLEAR_MICRO:
+			{
+				u32 vu_micro_addr = Read();
+				u32 size = Read();
+				vuCPU->Clear(vu_micro_addr, size);
+				break;
+			}
 			case MTVU_VU_WRITE_DATA:
 			{
 				u32 vu_data_addr = Read();
@@ -186,6 +207,16 @@ void VU_Thread::ExecuteRingBuffer()
 				m_read_pos += size_u32(size);
 				break;
 			}
+			case MTVU_VIF_UNPACK_REF:
+			{
+				u32 vif_copy_size = (uptr)&vif.StructEnd - (uptr)&vif.tag;
+				Read(&vif.tag, vif_copy_size);
+				ReadRegs(&vifRegs);
+				MTVU_Unpack(ReadPtr(), vifRegs);
+				// Only this thread writes it, the EE waits on it in WaitRefs()
+				m_ato_refs_read.store(m_ato_refs_read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+				break;
+			}
 			case MTVU_NULL_PACKET:
 				m_read_pos = 0;
 				break;
@@ -198,30 +229,65 @@ void VU_Thread::ExecuteRingBuffer()
 }
 
 
+// Spins for a while, then parks the EE thread until done() holds.  The spin
+// budget grows while waits end in time and shrinks when the EE has to park,
+// so short waits stay cheap and long ones don't burn a core.
+template <typename Done>
+__ri void VU_Thread::WaitFor(Done done)
+{
+	if (done())
+		return;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool parked = false;
+
+	KickStart();
+	for (s32 spins = 0; !done(); spins++)
+	{
+		if (spins < m_spin_budget)
+		{
+			Threading::SpinWait();
+			continue;
+		}
+
+		// Pairs with the fence in CommitReadPos(): either the VU thread sees
+		// the flag and posts, or we see its progress and don't sleep.
+		m_ato_ee_waiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!done())
+		{
+			// A forced kick can't get lost while the VU thread is going idle.
+			// The timeout is a safety net only.
+			KickStart(true);
+			semaEEWait.WaitWithoutYield(wxTimeSpan::Millisecond());
+			m_stats.parks++;
+			parked = true;
+		}
+		m_ato_ee_waiting.store(false, std::memory_order_relaxed);
+	}
+
+	if (parked)
+		m_spin_budget = std::max(m_spin_budget / 2, MTVU_SPIN_MIN);
+	else
+		m_spin_budget = std::min(m_spin_budget * 2, MTVU_SPIN_MAX);
+
+	m_stats.stallUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 // Should only be called by ReserveSpace()
 __ri void VU_Thread::WaitOnSize(s32 size)
 {
-	for (;;)
-	{
+	WaitFor([this, size]() {
 		s32 readPos = GetReadPos();
 		if (readPos <= m_write_pos)
-			break; // MTVU is reading in back of write_pos
+			return true; // MTVU is reading in back of write_pos
 		// FIXME greg: there is a bug somewhere in the queue pointer
 		// management. It creates a deadlock/corruption in SotC intro (before
 		// the first menu). I added a 4KB safety net which seem to avoid to
 		// trigger the bug.
 		// Note: a wait lock instead of a yield also helps to avoid the bug.
-		if (readPos > m_write_pos + size + _4kb)
-			break; // Enough free front space
-		{          // Let MTVU run to free up buffer space
-			KickStart();
-			// Locking might trigger a full flush of the ring buffer. Yield
-			// will be more aggressive, and only flush the minimal size.
-			// Performance will be smoother but it will consume extra CPU cycle
-			// on the EE thread (not an issue on 4 cores).
-			std::this_thread::yield();
-		}
-	}
+		return readPos > m_write_pos + size + _4kb; // Enough free front space
+	});
 }
 
 // Makes sure theres enough room in the ring buffer
@@ -276,6 +342,11 @@ __fi void VU_Thread::CommitWritePos()
 __fi void VU_Thread::CommitReadPos()
 {
 	m_ato_read_pos.store(m_read_pos, std::memory_order_release);
+
+	// Wake the EE if it parked in WaitFor(), see there for the fence pairing
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_ato_ee_waiting.load(std::memory_order_relaxed) && m_ato_ee_waiting.exchange(false))
+		semaEEWait.Post();
 }
 
 __fi u32 VU_Thread::Read()
@@ -315,6 +386,20 @@ __fi void VU_Thread::Write(void* src, u32 size)
 	m_write_pos += size_u32(size);
 }
 
+__fi void* VU_Thread::ReadPtr()
+{
+	void* ret;
+	memcpy(&ret, &buffer[m_read_pos], sizeof(ret));
+	m_read_pos += size_u32(sizeof(ret));
+	return ret;
+}
+
+__fi void VU_Thread::WritePtr(const void* ptr)
+{
+	memcpy(GetWritePtr(), &ptr, sizeof(ptr));
+	m_write_pos += size_u32(sizeof(ptr));
+}
+
 __fi void VU_Thread::WriteRegs(VIFregisters* src)
 {
 	VIFregistersMTVU* dest = (VIFregistersMTVU*)GetWritePtr();
@@ -414,18 +499,25 @@ void VU_Thread::WaitVU()
 #if 0
 	MTVU_LOG("MTVU - WaitVU!");
 #endif
-	for (;;)
-	{
-		if (IsDone())
-			break;
-#if 0
-		log_cb(RETRO_LOG_DEBUG, "WaitVU()\n");
-		pxAssert(THREAD_VU1);
+	WaitFor([this]() { return IsDone(); });
+}
+
+void VU_Thread::WaitRefs()
+{
+	WaitFor([this]() { return m_ato_refs_read.load(std::memory_order_acquire) == m_refs_written; });
+}
+
+void VU_Thread::Vsync()
+{
+	m_lastStats = m_stats;
+	memzero(m_stats);
+
+#ifndef NDEBUG
+	static u32 frames = 0;
+	if (++frames % 300 == 0)
+		log_cb(RETRO_LOG_DEBUG, "MTVU: %llu KB copied, %llu KB by reference, %llu us stalled, %u parks\n",
+			m_lastStats.bytesCopied >> 10, m_lastStats.bytesReferenced >> 10, m_lastStats.stallUs, m_lastStats.parks);
 #endif
-		KickStart();
-		std::this_thread::yield(); // Give a chance to the MTVU thread to actually start
-		ScopedLock lock(mtxBusy);
-	}
 }
 
 void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
@@ -448,18 +540,32 @@ void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
 	Get_GSChanges();
 }
 
-void VU_Thread::VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32 size)
+void VU_Thread::VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32 size, bool stable)
 {
 #if 0
 	MTVU_LOG("MTVU - VifUnpack!");
 #endif
 	u32 vif_copy_size = (uptr)&_vif.StructEnd - (uptr)&_vif.tag;
+	if (stable)
+	{
+		ReserveSpace(1 + size_u32(vif_copy_size) + size_u32(sizeof(VIFregistersMTVU)) + size_u32(sizeof(data)));
+		Write(MTVU_VIF_UNPACK_REF);
+		Write(&_vif.tag, vif_copy_size);
+		WriteRegs(&_vifRegs);
+		WritePtr(data);
+		m_refs_written++;
+		m_stats.bytesReferenced += size;
+		CommitWritePos();
+		KickStart();
+		return;
+	}
 	ReserveSpace(1 + size_u32(vif_copy_size) + size_u32(sizeof(VIFregistersMTVU)) + 1 + size_u32(size));
 	Write(MTVU_VIF_UNPACK);
 	Write(&_vif.tag, vif_copy_size);
 	WriteRegs(&_vifRegs);
 	Write(size);
 	Write(data, size);
+	m_stats.bytesCopied += size;
 	CommitWritePos();
 	KickStart();
 }
@@ -469,11 +575,24 @@ void VU_Thread::WriteMicroMem(u32 vu_micro_addr, void* data, u32 size)
 #if 0
 	MTVU_LOG("MTVU - WriteMicroMem!");
 #endif
+	// Savestates load straight into VU1 memory, only the rec needs to know.
+	if (data == &vuRegs.Micro[vu_micro_addr])
+	{
+		ReserveSpace(3);
+		Write(MTVU_VU_CLEAR_MICRO);
+		Write(vu_micro_addr);
+		Write(size);
+		m_stats.bytesReferenced += size;
+		CommitWritePos();
+		KickStart();
+		return;
+	}
 	ReserveSpace(3 + size_u32(size));
 	Write(MTVU_VU_WRITE_MICRO);
 	Write(vu_micro_addr);
 	Write(size);
 	Write(data, size);
+	m_stats.bytesCopied += size;
 	CommitWritePos();
 	KickStart();
 }
@@ -483,11 +602,18 @@ void VU_Thread::WriteDataMem(u32 vu_data_addr, void* data, u32 size)
 #if 0
 	MTVU_LOG("MTVU - WriteDataMem!");
 #endif
+	// Already in place (savestate load), nothing to hand over.
+	if (data == &vuRegs.Mem[vu_data_addr])
+	{
+		m_stats.bytesReferenced += size;
+		return;
+	}
 	ReserveSpace(3 + size_u32(size));
 	Write(MTVU_VU_WRITE_DATA);
 	Write(vu_data_addr);
 	Write(size);
 	Write(data, size);
+	m_stats.bytesCopied += size;
 	CommitWritePos();
 	KickStart();
 }
@@ -35,8 +35,13 @@ class VU_Thread : public pxThread {
 	__aligned(64) std::atomic<int> m_ato_write_pos;    // Only modified by EE thread
 	__aligned(64) int  m_read_pos; // temporary read pos (local to the VU thread)
 	int  m_write_pos; // temporary write pos (local to the EE thread)
+	__aligned(64) std::atomic<u32> m_ato_refs_read; // Reference packets consumed (VU thread)
+	u32  m_refs_written; // Reference packets queued (EE thread)
+	__aligned(64) std::atomic<bool> m_ato_ee_waiting; // EE is parked on semaEEWait
 	Mutex     mtxBusy;
 	Semaphore semaEvent;
+	Semaphore semaEEWait;
+	s32 m_spin_budget; // SpinWait() iterations before the EE parks (adaptive)
 	BaseVUmicroCPU*& vuCPU;
 	VURegs&          vuRegs;
 
@@ -57,6 +62,15 @@ public:
 	std::atomic<u64> gsLabel; // Used for GS Label command
 	std::atomic<u64> gsSignal; // Used for GS Signal command
 
+	// EE side cost of feeding the VU thread, counted over one frame.
+	struct FrameStats
+	{
+		u64 bytesCopied;     // payload copied into the ring
+		u64 bytesReferenced; // payload handed over by reference
+		u64 stallUs;         // time spent waiting on the VU thread
+		u32 parks;           // waits that had to sleep
+	};
+
 	VU_Thread(BaseVUmicroCPU*& _vuCPU, VURegs& _vuRegs);
 	virtual ~VU_Thread();
 
@@ -71,11 +85,21 @@ public:
 	// Waits till MTVU is done processing
 	void WaitVU();
 
+	// Waits till no queued packet references EE memory any more.  Call
+	// before overwriting a buffer that was passed with stable = true.
+	void WaitRefs();
+
+	// Counters of the previous frame, rolled over by Vsync()
+	const FrameStats& GetFrameStats() const { return m_lastStats; }
+	void Vsync();
+
 	void Get_GSChanges();
 
 	void ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop);
 
-	void VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32 size);
+	// stable: data stays untouched until WaitRefs(), so it is passed by
+	// reference instead of being copied into the ring.
+	void VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32 size, bool stable = false);
 
 	// Writes to VU's Micro Memory (size in bytes)
 	void WriteMicroMem(u32 vu_micro_addr, void* data, u32 size);
@@ -93,6 +117,7 @@ protected:
 private:
 	void ExecuteRingBuffer();
 
+	template <typename Done> void WaitFor(Done done);
 	void WaitOnSize(s32 size);
 	void ReserveSpace(s32 size);
 
@@ -111,8 +136,13 @@ private:
 	void Write(u32 val);
 	void Write(void* src, u32 size);
 	void WriteRegs(VIFregisters* src);
+	void WritePtr(const void* ptr);
+	void* ReadPtr();
 
 	u32 Get_vuCycles();
+
+	FrameStats m_stats;
+	FrameStats m_lastStats;
 };
 
 extern __aligned16 VU_Thread vu1Thread;
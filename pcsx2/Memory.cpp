@@ -734,6 +734,9 @@ void eeMemoryReserve::Reset()
 	
 	_parent::Reset();
 
+	// The reset recommits main memory, which drops any dirty tracking protection.
+	mmap_MarkAllRamDirty();
+
 	// Note!!  Ideally the vtlb should only be initialized once, and then subsequent
 	// resets of the system hardware would only clear vtlb mappings, but since the
 	// rest of the emu is not really set up to support a "soft" reset of that sort
@@ -906,6 +909,13 @@ struct vtlb_PageProtectionInfo
 
 static __aligned16 vtlb_PageProtectionInfo m_PageProtectInfo[Ps2MemSize::MainRam >> 12];
 
+// Snapshot dirty tracking -- one flag per page of main ram, set by the page fault handler
+// on the first write to a page after a snapshot.  Clean pages are kept write protected
+// (in addition to pages protected for the recompiler), so a page costs one fault per
+// snapshot at most.
+static u8 m_DirtyPages[Ps2MemSize::MainRam >> 12];
+static bool m_DirtyTracking = false;
+
 
 // returns:
 //  ProtMode_NotRequired - unchecked block (resides in ROM, thus is integrity is constant)
@@ -984,10 +994,36 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 	uptr offset = info.addr - (uptr)eeMem->Main;
 	if( offset >= Ps2MemSize::MainRam ) return;
 
-	mmap_ClearCpuBlock( offset );
+	int rampage = offset >> 12;
+	if( m_DirtyTracking ) m_DirtyPages[rampage] = 1;
+
+	// Pages which aren't protected for the recompiler were protected for dirty tracking
+	// only; those just need to be opened up again.
+	if( m_PageProtectInfo[rampage].Mode == ProtMode_Write )
+		mmap_ClearCpuBlock( offset );
+	else
+		HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+
 	handled = true;
 }
 
+// Write protects every clean page, coalescing runs of pages into a single call.
+static void mmap_ProtectCleanPages()
+{
+	const int pages = Ps2MemSize::MainRam >> 12;
+
+	for( int start = 0; start < pages; )
+	{
+		if( m_DirtyPages[start] ) { ++start; continue; }
+
+		int end = start + 1;
+		while( end < pages && !m_DirtyPages[end] ) ++end;
+
+		HostSys::MemProtect( &eeMem->Main[start<<12], (end-start) * __pagesize, PageAccess_ReadOnly() );
+		start = end;
+	}
+}
+
 // Clears all block tracking statuses, manual protection flags, and write protection.
 // This does not clear any recompiler blocks.  It is assumed (and necessary) for the caller
 // to ensure the EErec is also reset in conjunction with calling this function.
@@ -999,4 +1035,72 @@ void mmap_ResetBlockTracking()
 #endif
 	memzero( m_PageProtectInfo );
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
+
+	// Dirty tracking outlives a recompiler reset, so clean pages have to stay protected.
+	if (eeMem && m_DirtyTracking) mmap_ProtectCleanPages();
+}
+
+// --------------------------------------------------------------------------------------
+//  Snapshot dirty tracking
+// --------------------------------------------------------------------------------------
+// Used by delta savestates: a baseline copy of main memory is kept by the caller, and only
+// the pages written since it was last brought up to date need to be copied to (or from)
+// it.  Tracking shares the write protection used by the recompiler's block checks above;
+// a fault on a page under ProtMode_Write still clears the recompiled blocks as usual.
+
+void mmap_SetDirtyTracking( bool enabled )
+{
+	if( m_DirtyTracking == enabled ) return;
+
+	// Everything starts out dirty: the caller's baseline is undefined until the first commit.
+	// Pages left protected from a previous run of tracking are unprotected on their next write.
+	memset( m_DirtyPages, 1, sizeof(m_DirtyPages) );
+	m_DirtyTracking = enabled;
+}
+
+// Forces the next commit to copy all of main memory (after loading a full state, for
+// example).  Pages that are still write protected are unprotected on their next write.
+void mmap_MarkAllRamDirty()
+{
+	memset( m_DirtyPages, 1, sizeof(m_DirtyPages) );
+}
+
+// Copies every page written since the last commit or revert into the baseline, and starts
+// tracking again from a clean slate.  The VM must be paused.  Returns the number of pages
+// copied.
+uint mmap_CommitDirtyRam( u8* baseline )
+{
+	pxAssert( eeMem && m_DirtyTracking );
+
+	uint count = 0;
+	for( uint page = 0; page < ArraySize(m_DirtyPages); ++page )
+	{
+		if( !m_DirtyPages[page] ) continue;
+		memcpy( &baseline[page<<12], &eeMem->Main[page<<12], __pagesize );
+		++count;
+	}
+
+	memzero( m_DirtyPages );
+	mmap_ProtectCleanPages();
+	return count;
+}
+
+// Restores every page written since the last commit from the baseline, so that main memory
+// matches the baseline again.  The VM must be paused, and the recompiler reset beforehand
+// (which also lifts its write protection).  Returns the number of pages restored.
+uint mmap_RevertDirtyRam( const u8* baseline )
+{
+	pxAssert( eeMem && m_DirtyTracking );
+
+	uint count = 0;
+	for( uint page = 0; page < ArraySize(m_DirtyPages); ++page )
+	{
+		if( !m_DirtyPages[page] ) continue;
+		memcpy( &eeMem->Main[page<<12], &baseline[page<<12], __pagesize );
+		++count;
+	}
+
+	memzero( m_DirtyPages );
+	mmap_ProtectCleanPages();
+	return count;
 }
@@ -128,6 +128,11 @@ extern vtlb_ProtectionMode mmap_GetRamPageInfo( u32 paddr );
 extern void mmap_MarkCountedRamPage( u32 paddr );
 extern void mmap_ResetBlockTracking();
 
+extern void mmap_SetDirtyTracking( bool enabled );
+extern void mmap_MarkAllRamDirty();
+extern uint mmap_CommitDirtyRam( u8* baseline );
+extern uint mmap_RevertDirtyRam( const u8* baseline );
+
 #define memRead8 vtlb_memRead<mem8_t>
 #define memRead16 vtlb_memRead<mem16_t>
 #define memRead32 vtlb_memRead<mem32_t>
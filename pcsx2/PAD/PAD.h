@@ -100,6 +100,7 @@ s32 PADinit(u32 flags);
 u8 PADpoll(u8 value);
 s32 PADsetSlot(u8 port, u8 slot);
 void PADshutdown();
+s32 PADfreeze(int mode, freezeData *data);
 
 void GamePad_DoRumble(unsigned type, unsigned pad);
 
@@ -21,7 +21,9 @@
 #include "Patch.h"
 #include "GameDatabase.h"
 #include "MemoryPatchDatabase.h"
+#include "vtlb.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <wx/textfile.h>
@@ -40,6 +42,38 @@ extern void _ApplyPatch(IniPatch* p);
 
 std::vector<IniPatch> Patch;
 
+// The loaded patches of each place, decoded once for ApplyLoadedPatches().
+// Plain EE writes to main memory are resolved to host pointers and applied in
+// runs of the same width, so the vsync pass neither dispatches on cpu and type
+// nor walks the vtlb for them.  Anything else (IOP writes, extended codes,
+// hardware registers) is applied in file order through _ApplyPatch() or the vtlb.
+struct PatchWrite
+{
+	u32 addr;   // index into Patch when width is 0
+	u32 width;  // in bytes, 0 for patches applied through _ApplyPatch()
+	u64 data;
+	void* host; // resolved main memory, NULL to write through the vtlb
+};
+
+// Consecutive writes of the same width
+struct PatchRun
+{
+	u32 width;
+	u32 begin;
+	u32 end;
+};
+
+struct CompiledPatches
+{
+	std::vector<PatchWrite> decoded; // file order
+	std::vector<PatchWrite> writes;  // resolved and grouped, in application order
+	std::vector<PatchRun> runs;
+};
+
+static CompiledPatches s_compiledPatches[_PPT_END_MARKER];
+static bool s_patchesCompiled = false;
+static u32 s_patchesResolved; // vmap generation of the host pointers
+
 struct PatchTextTable
 {
 	int				code;
@@ -165,6 +199,7 @@ void inifile_process(wxTextFile& f1)
 void ForgetLoadedPatches()
 {
 	Patch.clear();
+	s_patchesCompiled = false;
 }
 
 static int _LoadPatchFiles(const wxDirName& folderName, wxString& fileSpec, const wxString& friendlyName, int& numberFoundPatchFiles)
@@ -378,6 +413,7 @@ namespace PatchFunc
 
 			iPatch.enabled = 1; // omg success!!
 			Patch.push_back(iPatch);
+			s_patchesCompiled = false;
 		}
 
 		return;
@@ -387,12 +423,180 @@ error:
 	void patch(const wxString& cmd, const wxString& param) { patchHelper(cmd, param); }
 } // namespace PatchFunc
 
+static uint PatchWidth(const IniPatch& p)
+{
+	if (p.cpu != CPU_EE)
+		return 0;
+
+	switch (p.type)
+	{
+		case BYTE_T:   return 1;
+		case SHORT_T:  return 2;
+		case WORD_T:   return 4;
+		case DOUBLE_T: return 8;
+		default:       return 0;
+	}
+}
+
+static void CompilePatches(CompiledPatches& out, patch_place_type place)
+{
+	out.decoded.clear();
+
+	for (u32 i = 0; i < Patch.size(); i++)
+	{
+		const IniPatch& p = Patch[i];
+		if (!p.enabled || p.placetopatch != place)
+			continue;
+
+		if (uint width = PatchWidth(p))
+			out.decoded.push_back({ p.addr, width, p.data, NULL });
+		else
+			out.decoded.push_back({ i, 0, 0, NULL });
+	}
+}
+
+// Only main memory is written through a host pointer: a store there has no side
+// effect besides the page protection that invalidates recompiled code, which
+// fires the same way for vtlb writes.
+static void* ResolvePatchHost(const PatchWrite& w)
+{
+	if (w.width == 0)
+		return NULL;
+
+	const auto vmv = vtlb_private::vtlbdata.vmap[w.addr >> vtlb_private::VTLB_PAGE_BITS];
+	if (vmv.isHandler(w.addr))
+		return NULL;
+
+	u8* host = (u8*)vmv.assumePtr(w.addr);
+	if (host < eeMem->Main || host + w.width > eeMem->Main + Ps2MemSize::MainRam)
+		return NULL;
+
+	return host;
+}
+
+// Main memory writes that don't overlap can go in any order, so a block of them
+// is sorted by width.  If any two touch the same bytes, file order is kept.
+static void SortByWidth(std::vector<PatchWrite>::iterator first, std::vector<PatchWrite>::iterator last)
+{
+	std::vector<std::pair<uptr, uptr>> ranges;
+	for (auto w = first; w != last; ++w)
+		ranges.push_back({ (uptr)w->host, (uptr)w->host + w->width });
+
+	std::sort(ranges.begin(), ranges.end());
+	for (size_t i = 1; i < ranges.size(); i++)
+	{
+		if (ranges[i].first < ranges[i - 1].second)
+			return;
+	}
+
+	std::stable_sort(first, last, [](const PatchWrite& a, const PatchWrite& b) {
+		return a.width < b.width;
+	});
+}
+
+// Resolves the host pointers against the current vtlb mappings and groups the
+// writes into runs.  Patches that can't be written directly stay in place and
+// split the blocks around them, so they keep their order with everything else.
+static void ResolvePatches(CompiledPatches& c)
+{
+	c.writes.clear();
+	c.runs.clear();
+
+	for (size_t i = 0; i < c.decoded.size();)
+	{
+		const size_t block = c.writes.size();
+
+		for (; i < c.decoded.size(); i++)
+		{
+			PatchWrite w = c.decoded[i];
+			if (!(w.host = ResolvePatchHost(w)))
+				break;
+			c.writes.push_back(w);
+		}
+
+		SortByWidth(c.writes.begin() + block, c.writes.end());
+
+		if (i < c.decoded.size())
+			c.writes.push_back(c.decoded[i++]);
+
+		for (u32 j = block; j < c.writes.size(); j++)
+		{
+			if (!c.runs.empty() && c.runs.back().width == c.writes[j].width)
+				c.runs.back().end = j + 1;
+			else
+				c.runs.push_back({ c.writes[j].width, j, j + 1 });
+		}
+	}
+}
+
+// Writes only what differs, so recompiled code on a patched page is only
+// invalidated when a patch actually changes it.
+template< typename T >
+static __fi void ApplyPatchWrite(u32 addr, T data)
+{
+	if (vtlb_memRead<T>(addr) != data)
+		vtlb_memWrite<T>(addr, data);
+}
+
+template<>
+__fi void ApplyPatchWrite<u64>(u32 addr, u64 data)
+{
+	u64 mem;
+	memRead64(addr, &mem);
+	if (mem != data)
+		memWrite64(addr, &data);
+}
+
+template< typename T >
+static __fi void ApplyPatchRun(const PatchWrite* w, const PatchWrite* end)
+{
+	for (; w != end; w++)
+	{
+		if (T* host = (T*)w->host)
+		{
+			if (*host != (T)w->data)
+				*host = (T)w->data;
+		}
+		else
+			ApplyPatchWrite<T>(w->addr, (T)w->data);
+	}
+}
+
 // This is for applying patches directly to memory
 void ApplyLoadedPatches(patch_place_type place)
 {
-	for (auto& i : Patch)
+	// TLB changes remap EE pages, the host pointers are resolved again after any of them
+	const u32 generation = vtlb_private::vtlbdata.vmap_generation;
+
+	if (!s_patchesCompiled || s_patchesResolved != generation)
 	{
-		if (i.placetopatch == place)
-			_ApplyPatch(&i);
+		for (int i = 0; i < _PPT_END_MARKER; i++)
+		{
+			if (!s_patchesCompiled)
+				CompilePatches(s_compiledPatches[i], (patch_place_type)i);
+			ResolvePatches(s_compiledPatches[i]);
+		}
+		s_patchesCompiled = true;
+		s_patchesResolved = generation;
+	}
+
+	const CompiledPatches& c = s_compiledPatches[place];
+
+	for (const PatchRun& run : c.runs)
+	{
+		const PatchWrite* w = c.writes.data() + run.begin;
+		const PatchWrite* end = c.writes.data() + run.end;
+
+		switch (run.width)
+		{
+			case 1: ApplyPatchRun<u8>(w, end); break;
+			case 2: ApplyPatchRun<u16>(w, end); break;
+			case 4: ApplyPatchRun<u32>(w, end); break;
+			case 8: ApplyPatchRun<u64>(w, end); break;
+			default:
+				for (; w != end; w++)
+					_ApplyPatch(&Patch[w->addr]);
+				break;
+		}
 	}
 }
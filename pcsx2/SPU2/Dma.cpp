@@ -138,14 +138,9 @@ void V_Core::PlainDMAWrite(u16* pMem, u32 size)
 
 	const int cacheIdxStart = TSA / pcm_WordsPerBlock;
 	const int cacheIdxEnd = (buff1end + pcm_WordsPerBlock - 1) / pcm_WordsPerBlock;
-	PcmCacheEntry* cacheLine = &pcm_cache_data[cacheIdxStart];
-	PcmCacheEntry& cacheEnd = pcm_cache_data[cacheIdxEnd];
 
-	do
-	{
-		cacheLine->Validated = false;
-		cacheLine++;
-	} while (cacheLine != &cacheEnd);
+	for (int cacheIdx = cacheIdxStart; cacheIdx < cacheIdxEnd; cacheIdx++)
+		InvalidatePcmCacheEntry(cacheIdx);
 
 	//ConLog( "* SPU2: Cache Clear Range!  TSA=0x%x, TDA=0x%x (low8=0x%x, high8=0x%x, len=0x%x)\n",
 	//	TSA, buff1end, flagTSA, flagTDA, clearLen );
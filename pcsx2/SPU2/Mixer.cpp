@@ -16,8 +16,10 @@
 #include "PrecompiledHeader.h"
 #include "Global.h"
 
-/* Forward declaration */
-extern retro_audio_sample_t sample_cb;
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
 
 static const s32 tbl_XA_Factor[16][2] =
 	{
@@ -124,7 +126,53 @@ static void __forceinline IncrementNextA(V_Core& thiscore, uint voiceidx)
 // decoded pcm data, used to cache the decoded data so that it needn't be decoded
 // multiple times.  Cache chunks are decoded when the mixer requests the blocks, and
 // invalided when DMA transfers and memory writes are performed.
-PcmCacheEntry* pcm_cache_data = nullptr;
+PcmCachePage* pcm_cache_pages[pcm_PageCount] = {};
+
+static int pcm_CommittedPages = 0;
+static u64 pcm_CacheHits = 0;
+static u64 pcm_CacheMisses = 0;
+
+PcmCachePage* CommitPcmCachePage(int pageIdx)
+{
+	PcmCachePage* page = (PcmCachePage*)calloc(1, sizeof(PcmCachePage));
+	if (page == nullptr)
+		throw Exception::OutOfMemory(L"SPU2 ADPCM cache page");
+
+	pcm_cache_pages[pageIdx] = page;
+	pcm_CommittedPages++;
+	return page;
+}
+
+// Clears all cache flags and buffers, leaving the pages committed (voices may still
+// point into them).
+void WipePcmCache()
+{
+	for (PcmCachePage* page : pcm_cache_pages)
+	{
+		if (page)
+			memset(page, 0, sizeof(PcmCachePage));
+	}
+}
+
+void ReleasePcmCache()
+{
+	for (PcmCachePage*& page : pcm_cache_pages)
+		safe_free(page);
+
+	pcm_CommittedPages = 0;
+	pcm_CacheHits = 0;
+	pcm_CacheMisses = 0;
+}
+
+void ReportPcmCacheStats()
+{
+	const u64 lookups = pcm_CacheHits + pcm_CacheMisses;
+
+	log_cb(RETRO_LOG_DEBUG, "SPU2: ADPCM cache: %llu hits, %llu misses (%.1f%% hit rate), %d/%d pages committed (%u KB)\n",
+		(unsigned long long)pcm_CacheHits, (unsigned long long)pcm_CacheMisses,
+		lookups ? 100.0 * pcm_CacheHits / lookups : 0.0,
+		pcm_CommittedPages, pcm_PageCount, (uint)(pcm_CommittedPages * sizeof(PcmCachePage) / 1024));
+}
 
 // LOOP/END sets the ENDX bit and sets NAX to LSA, and the voice is muted if LOOP is not set
 // LOOP seems to only have any effect on the block with LOOP/END set, where it prevents muting the voice
@@ -174,11 +222,13 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 			vc.LoopStartA = vc.NextA & 0xFFFF8;
 
 		const int cacheIdx = vc.NextA / pcm_WordsPerBlock;
-		PcmCacheEntry& cacheLine = pcm_cache_data[cacheIdx];
+		PcmCacheEntry& cacheLine = GetPcmCacheEntry(cacheIdx);
 		vc.SBuffer = cacheLine.Sampledata;
 
 		if (cacheLine.Validated)
 		{
+			pcm_CacheHits++;
+
 			// Cached block!  Read from the cache directly.
 			// Make sure to propagate the prev1/prev2 ADPCM:
 
@@ -189,6 +239,8 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 		}
 		else
 		{
+			pcm_CacheMisses++;
+
 			// Only flag the cache if it's a non-dynamic memory range.
 			if (vc.NextA >= SPU2_DYN_MEMLINE)
 				cacheLine.Validated = true;
@@ -379,11 +431,10 @@ __forceinline static s32 CubicInterpolate(
 	return (val + (y1 << 1));
 }
 
-// Returns a 16 bit result in Value.
-// Uses standard template-style optimization techniques to statically generate five different
-// versions of this function (one for each type of interpolation).
+// Advances the voice's sample history until the sample pointer is back in the
+// interpolation window, decoding ADPCM blocks as needed.
 template <int InterpType>
-static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+static __forceinline void FetchVoiceValues(V_Core& thiscore, uint voiceidx)
 {
 	V_Voice& vc(thiscore.Voices[voiceidx]);
 
@@ -398,6 +449,17 @@ static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
 		vc.PV1 = GetNextDataBuffered(thiscore, voiceidx);
 		vc.SP -= 4096;
 	}
+}
+
+// Returns a 16 bit result in Value.
+// Uses standard template-style optimization techniques to statically generate five different
+// versions of this function (one for each type of interpolation).
+template <int InterpType>
+static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+{
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	FetchVoiceValues<InterpType>(thiscore, voiceidx);
 
 	const s32 mu = vc.SP + 4096;
 
@@ -469,28 +531,13 @@ static __forceinline void spu2M_WriteFast(u32 addr, s16 value)
 }
 
 
-static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
+// Runs the source, interpolation and envelope stages of a voice and returns its
+// post-ADSR output (ranged at 16 bits).  Silent voices return 0.
+static __forceinline s32 RenderVoice(uint coreidx, uint voiceidx)
 {
 	V_Core& thiscore(Cores[coreidx]);
 	V_Voice& vc(thiscore.Voices[voiceidx]);
 
-	// If this assertion fails, it mans SCurrent is being corrupted somewhere, or is not initialized
-	// properly.  Invalid values in SCurrent will cause errant IRQs and corrupted audio.
-	pxAssertMsg((vc.SCurrent <= 28) && (vc.SCurrent != 0), "Current sample should always range from 1->28");
-
-	// Most games don't use much volume slide effects.  So only call the UpdateVolume
-	// methods when needed by checking the flag outside the method here...
-	// (Note: Ys 6 : Ark of Nephistm uses these effects)
-
-	vc.Volume.Update();
-
-	// SPU2 Note: The spu2 continues to process voices for eternity, always, so we
-	// have to run through all the motions of updating the voice regardless of it's
-	// audible status.  Otherwise IRQs might not trigger and emulation might fail.
-
-	UpdatePitch(coreidx, voiceidx);
-
-	StereoOut32 voiceOut(0, 0);
 	s32 Value = 0;
 
 	if (vc.ADSR.Phase > 0)
@@ -534,8 +581,6 @@ static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
 		CalculateADSR(thiscore, voiceidx);
 		Value    = MulShr32(Value, vc.ADSR.Value);
 		vc.OutX  = Value;
-
-		voiceOut = ApplyVolume(StereoOut32(Value, Value), vc.Volume);
 	}
 	else
 	{
@@ -550,14 +595,323 @@ static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
 	else if (voiceidx == 3)
 		spu2M_WriteFast(((0 == coreidx) ? 0x600 : 0xe00) + OutPos, Value);
 
-	return voiceOut;
+	return Value;
+}
+
+static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
+{
+	V_Core& thiscore(Cores[coreidx]);
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	// If this assertion fails, it mans SCurrent is being corrupted somewhere, or is not initialized
+	// properly.  Invalid values in SCurrent will cause errant IRQs and corrupted audio.
+	pxAssertMsg((vc.SCurrent <= 28) && (vc.SCurrent != 0), "Current sample should always range from 1->28");
+
+	// Most games don't use much volume slide effects.  So only call the UpdateVolume
+	// methods when needed by checking the flag outside the method here...
+	// (Note: Ys 6 : Ark of Nephistm uses these effects)
+
+	vc.Volume.Update();
+
+	// SPU2 Note: The spu2 continues to process voices for eternity, always, so we
+	// have to run through all the motions of updating the voice regardless of it's
+	// audible status.  Otherwise IRQs might not trigger and emulation might fail.
+
+	UpdatePitch(coreidx, voiceidx);
+
+	const s32 Value = RenderVoice(coreidx, voiceidx);
+
+	// A silent voice renders 0, which the volume stage keeps at 0.
+	return ApplyVolume(StereoOut32(Value, Value), vc.Volume);
 }
 
 const VoiceMixSet VoiceMixSet::Empty((StereoOut32()), (StereoOut32())); // Don't use SteroOut32::Empty because C++ doesn't make any dep/order checks on global initializers.
 
-static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
+// --------------------------------------------------------------------------------------
+//  Vectorized voice mixing
+// --------------------------------------------------------------------------------------
+// The per-voice work is split in two passes.  The first one walks the voices in order and
+// does everything that touches SPU2 RAM or has side effects (volume slides, pitch, ADPCM
+// decoding, IRQ checks, ADSR), gathering what's left into one array per field.  The second
+// pass runs interpolation, envelope, volume and gating on four voices per SSE register.
+//
+// Noise voices and voices 1 and 3 (whose output is written back to SPU2 RAM, where a later
+// voice may be reading from) are fully rendered in the first pass.  Every operation mirrors
+// the scalar code with the same integer widths, so output is bit-identical.
+
+struct __aligned16 VoiceLanes
+{
+	s32 PV1[V_Core::NumVoices];
+	s32 PV2[V_Core::NumVoices];
+	s32 PV3[V_Core::NumVoices];
+	s32 PV4[V_Core::NumVoices];
+	s32 SP[V_Core::NumVoices];
+	s32 ADSR[V_Core::NumVoices];
+
+	// Output of voices rendered in the first pass, selected by RenderedMask.
+	s32 Rendered[V_Core::NumVoices];
+	s32 RenderedMask[V_Core::NumVoices];
+
+	s32 VolL[V_Core::NumVoices];
+	s32 VolR[V_Core::NumVoices];
+	s32 DryL[V_Core::NumVoices];
+	s32 DryR[V_Core::NumVoices];
+	s32 WetL[V_Core::NumVoices];
+	s32 WetR[V_Core::NumVoices];
+
+	s32 Out[V_Core::NumVoices];
+};
+
+static_assert(V_Core::NumVoices % 4 == 0, "Voice lanes are processed four at a time");
+
+// Low 32 bits of a 32x32 multiply (signed and unsigned are the same).
+static __forceinline __m128i MulLo32(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+	return _mm_mullo_epi32(a, b);
+#else
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// Four-lane MulShr32: the high 32 bits of the full signed 64-bit product.
+static __forceinline __m128i MulShr32(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+	const __m128i even = _mm_mul_epi32(a, b);
+	const __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+#else
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+#endif
+	__m128i hi = _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 3, 1)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 3, 1)));
+#ifndef __SSE4_1__
+	// Turn the unsigned high half into the signed one.
+	hi = _mm_sub_epi32(hi, _mm_and_si128(_mm_srai_epi32(a, 31), b));
+	hi = _mm_sub_epi32(hi, _mm_and_si128(_mm_srai_epi32(b, 31), a));
+#endif
+	return hi;
+}
+
+static __forceinline s32 HorizontalSum(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+static __forceinline __m128i LoadLanes(const s32* src)
+{
+	return _mm_load_si128((const __m128i*)src);
+}
+
+// Four-lane versions of GetVoiceValues' interpolators, in the same operation order.
+template <int InterpType>
+static __forceinline __m128i InterpolateLanes(const VoiceLanes& lanes, uint voiceidx)
+{
+	const __m128i y3 = LoadLanes(&lanes.PV1[voiceidx]);
+
+	switch (InterpType)
+	{
+		case 0:
+			return _mm_slli_epi32(y3, 1);
+
+		case 1:
+		{
+			const __m128i sp = LoadLanes(&lanes.SP[voiceidx]);
+			const __m128i delta = MulLo32(_mm_sub_epi32(LoadLanes(&lanes.PV2[voiceidx]), y3), sp);
+			return _mm_sub_epi32(_mm_slli_epi32(y3, 1), _mm_srai_epi32(delta, 11));
+		}
+
+		default:
+			break;
+	}
+
+	const __m128i y2 = LoadLanes(&lanes.PV2[voiceidx]);
+	const __m128i y1 = LoadLanes(&lanes.PV3[voiceidx]);
+	const __m128i y0 = LoadLanes(&lanes.PV4[voiceidx]);
+	const __m128i mu = _mm_add_epi32(LoadLanes(&lanes.SP[voiceidx]), _mm_set1_epi32(4096));
+	const __m128i y1x2 = _mm_slli_epi32(y1, 1);
+
+	switch (InterpType)
+	{
+		case 2: // CubicInterpolate
+		{
+			const __m128i a0 = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(y3, y2), y0), y1);
+			const __m128i a1 = _mm_sub_epi32(_mm_sub_epi32(y0, y1), a0);
+			const __m128i a2 = _mm_sub_epi32(y2, y0);
+
+			__m128i val = _mm_srai_epi32(MulLo32(a0, mu), 12);
+			val = _mm_srai_epi32(MulLo32(_mm_add_epi32(val, a1), mu), 12);
+			val = _mm_srai_epi32(MulLo32(_mm_add_epi32(val, a2), mu), 11);
+			return _mm_add_epi32(val, y1x2);
+		}
+
+		case 3: // HermiteInterpolate<16384>
+		{
+			const __m128i m00 = _mm_srai_epi32(_mm_slli_epi32(_mm_sub_epi32(y1, y0), 14), 16);
+			const __m128i m01 = _mm_srai_epi32(_mm_slli_epi32(_mm_sub_epi32(y2, y1), 14), 16);
+			const __m128i m11 = _mm_srai_epi32(_mm_slli_epi32(_mm_sub_epi32(y3, y2), 14), 16);
+			const __m128i m0 = _mm_add_epi32(m00, m01);
+			const __m128i m1 = _mm_add_epi32(m01, m11);
+			const __m128i y2x2 = _mm_slli_epi32(y2, 1);
+
+			__m128i val = _mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(y1x2, m0), m1), y2x2);
+			val = _mm_srai_epi32(MulLo32(val, mu), 12);
+
+			val = _mm_sub_epi32(val, _mm_add_epi32(y1x2, y1));
+			val = _mm_sub_epi32(val, _mm_slli_epi32(m0, 1));
+			val = _mm_sub_epi32(val, m1);
+			val = _mm_add_epi32(val, _mm_add_epi32(y2x2, y2));
+			val = _mm_srai_epi32(MulLo32(val, mu), 12);
+
+			val = _mm_srai_epi32(MulLo32(_mm_add_epi32(val, m0), mu), 11);
+			return _mm_add_epi32(val, y1x2);
+		}
+
+		case 4: // CatmullRomInterpolate
+		{
+			const __m128i y1x3 = _mm_add_epi32(y1x2, y1);
+			const __m128i y2x3 = _mm_add_epi32(_mm_slli_epi32(y2, 1), y2);
+
+			const __m128i a3 = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(y1x3, y0), y2x3), y3);
+			const __m128i a2 = _mm_sub_epi32(
+				_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(y0, 1), _mm_add_epi32(_mm_slli_epi32(y1, 2), y1)), _mm_slli_epi32(y2, 2)),
+				y3);
+			const __m128i a1 = _mm_sub_epi32(y2, y0);
+
+			__m128i val = _mm_srai_epi32(MulLo32(a3, mu), 12);
+			val = _mm_srai_epi32(MulLo32(_mm_add_epi32(a2, val), mu), 12);
+			val = _mm_srai_epi32(MulLo32(_mm_add_epi32(a1, val), mu), 12);
+			return _mm_add_epi32(y1x2, val);
+		}
+
+			jNO_DEFAULT;
+	}
+
+	return _mm_setzero_si128(); // technically unreachable!
+}
+
+// First pass: advances every voice in order and gathers the lane inputs.
+template <int InterpType>
+static __forceinline void GatherVoiceLanes(VoiceLanes& lanes, uint coreidx)
+{
+	V_Core& thiscore(Cores[coreidx]);
+
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+	{
+		V_Voice& vc(thiscore.Voices[voiceidx]);
+
+		pxAssertMsg((vc.SCurrent <= 28) && (vc.SCurrent != 0), "Current sample should always range from 1->28");
+
+		vc.Volume.Update();
+		UpdatePitch(coreidx, voiceidx);
+
+		if (vc.ADSR.Phase == 0 || vc.Noise || voiceidx == 1 || voiceidx == 3)
+		{
+			lanes.Rendered[voiceidx] = RenderVoice(coreidx, voiceidx);
+			lanes.RenderedMask[voiceidx] = -1;
+
+			lanes.PV1[voiceidx] = lanes.PV2[voiceidx] = lanes.PV3[voiceidx] = lanes.PV4[voiceidx] = 0;
+			lanes.SP[voiceidx] = lanes.ADSR[voiceidx] = 0;
+		}
+		else
+		{
+			FetchVoiceValues<InterpType>(thiscore, voiceidx);
+
+			lanes.PV1[voiceidx] = vc.PV1;
+			lanes.PV2[voiceidx] = vc.PV2;
+			lanes.PV3[voiceidx] = vc.PV3;
+			lanes.PV4[voiceidx] = vc.PV4;
+			lanes.SP[voiceidx] = vc.SP;
+
+			CalculateADSR(thiscore, voiceidx);
+			lanes.ADSR[voiceidx] = vc.ADSR.Value;
+
+			lanes.Rendered[voiceidx] = 0;
+			lanes.RenderedMask[voiceidx] = 0;
+		}
+
+		lanes.VolL[voiceidx] = vc.Volume.Left.Value;
+		lanes.VolR[voiceidx] = vc.Volume.Right.Value;
+		lanes.DryL[voiceidx] = thiscore.VoiceGates[voiceidx].DryL;
+		lanes.DryR[voiceidx] = thiscore.VoiceGates[voiceidx].DryR;
+		lanes.WetL[voiceidx] = thiscore.VoiceGates[voiceidx].WetL;
+		lanes.WetR[voiceidx] = thiscore.VoiceGates[voiceidx].WetR;
+	}
+}
+
+template <int InterpType>
+static __forceinline void MixVoiceLanes(VoiceMixSet& dest, uint coreidx)
 {
 	V_Core& thiscore(Cores[coreidx]);
+	VoiceLanes lanes;
+
+	GatherVoiceLanes<InterpType>(lanes, coreidx);
+
+	__m128i dryL = _mm_setzero_si128();
+	__m128i dryR = _mm_setzero_si128();
+	__m128i wetL = _mm_setzero_si128();
+	__m128i wetR = _mm_setzero_si128();
+
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; voiceidx += 4)
+	{
+		const __m128i rendered = LoadLanes(&lanes.Rendered[voiceidx]);
+		const __m128i renderedMask = LoadLanes(&lanes.RenderedMask[voiceidx]);
+
+		__m128i value = MulShr32(InterpolateLanes<InterpType>(lanes, voiceidx), LoadLanes(&lanes.ADSR[voiceidx]));
+		value = _mm_or_si128(_mm_andnot_si128(renderedMask, value), _mm_and_si128(renderedMask, rendered));
+		_mm_store_si128((__m128i*)&lanes.Out[voiceidx], value);
+
+		// ApplyVolume
+		const __m128i scaled = _mm_slli_epi32(value, 1);
+		const __m128i left = MulShr32(scaled, LoadLanes(&lanes.VolL[voiceidx]));
+		const __m128i right = MulShr32(scaled, LoadLanes(&lanes.VolR[voiceidx]));
+
+		dryL = _mm_add_epi32(dryL, _mm_and_si128(left, LoadLanes(&lanes.DryL[voiceidx])));
+		dryR = _mm_add_epi32(dryR, _mm_and_si128(right, LoadLanes(&lanes.DryR[voiceidx])));
+		wetL = _mm_add_epi32(wetL, _mm_and_si128(left, LoadLanes(&lanes.WetL[voiceidx])));
+		wetR = _mm_add_epi32(wetR, _mm_and_si128(right, LoadLanes(&lanes.WetR[voiceidx])));
+	}
+
+	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+	{
+		if (!lanes.RenderedMask[voiceidx])
+			thiscore.Voices[voiceidx].OutX = lanes.Out[voiceidx];
+	}
+
+	dest.Dry.Left += HorizontalSum(dryL);
+	dest.Dry.Right += HorizontalSum(dryR);
+	dest.Wet.Left += HorizontalSum(wetL);
+	dest.Wet.Right += HorizontalSum(wetR);
+}
+
+// Pitch modulation feeds each voice's output into the next voice's pitch, so a core
+// using it has to be mixed one voice at a time.
+static __forceinline bool HasPitchModulation(const V_Core& thiscore)
+{
+	bool modulated = false;
+	for (uint voiceidx = 1; voiceidx < V_Core::NumVoices; ++voiceidx)
+		modulated |= thiscore.Voices[voiceidx].Modulated;
+	return modulated;
+}
+
+template <int InterpType>
+static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx, const bool serial)
+{
+	V_Core& thiscore(Cores[coreidx]);
+
+	if (!serial)
+	{
+		MixVoiceLanes<InterpType>(dest, coreidx);
+		return;
+	}
 
 	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
 	{
@@ -644,13 +998,10 @@ StereoOut32 V_Core::Mix(const VoiceMixSet& inVoices, const StereoOut32& Input, c
 	return TD + ApplyVolume(RV, FxVol);
 }
 
-// Gcc does not want to inline it when lto is enabled because some functions growth too much.
-// The function is big enought to see any speed impact. -- Gregory
-#ifndef __POSIX__
-__forceinline
-#endif
-	void
-	Mix()
+// Mixes one output sample.  'serial' selects the one-voice-at-a-time loop per core
+// (see HasPitchModulation).
+template <int InterpType>
+static __forceinline void MixSample(const bool serial[2])
 {
 	// Note: Playmode 4 is SPDIF, which overrides other inputs.
 	StereoOut32 InputData[2] =
@@ -666,8 +1017,8 @@ __forceinline
 
 	// Todo: Replace me with memzero initializer!
 	VoiceMixSet VoiceData[2] = {VoiceMixSet::Empty, VoiceMixSet::Empty}; // mixed voice data for each core.
-	MixCoreVoices(VoiceData[0], 0);
-	MixCoreVoices(VoiceData[1], 1);
+	MixCoreVoices<InterpType>(VoiceData[0], 0, serial[0]);
+	MixCoreVoices<InterpType>(VoiceData[1], 1, serial[1]);
 
 	StereoOut32 Ext(Cores[0].Mix(VoiceData[0], InputData[0], StereoOut32(0, 0)));
 
@@ -707,10 +1058,52 @@ __forceinline
 
 		Out = clamp_mix(Out, SndOutVolumeShift);
 	}
-	sample_cb(Out.Left >> 12, Out.Right >> 12);
+	SndBuffer::Write(StereoOut16(Out.Left >> SndOutVolumeShift, Out.Right >> SndOutVolumeShift));
 
 	// Update AutoDMA output positioning
 	OutPos++;
 	if (OutPos >= 0x200)
 		OutPos = 0;
 }
+
+// Voice flags and the interpolation mode only change through register writes and config
+// updates, and those always sync the mixer up (TimeUpdate) before taking effect.  So the
+// mixing setup is picked once and reused for the whole run.
+template <int InterpType>
+static uint MixRun(uint count)
+{
+	const bool serial[2] = {HasPitchModulation(Cores[0]), HasPitchModulation(Cores[1])};
+
+	for (uint mixed = 1; mixed <= count; ++mixed)
+	{
+		Cycles++;
+		MixSample<InterpType>(serial);
+
+		// An IRQ raised by this sample must be delivered before the next one is mixed.
+		if (has_to_call_irq)
+			return mixed;
+	}
+
+	return count;
+}
+
+uint MixBlock(uint count)
+{
+	switch (Interpolation)
+	{
+		case 0:
+			return MixRun<0>(count);
+		case 1:
+			return MixRun<1>(count);
+		case 2:
+			return MixRun<2>(count);
+		case 3:
+			return MixRun<3>(count);
+		case 4:
+			return MixRun<4>(count);
+
+			jNO_DEFAULT;
+	}
+
+	return 0; // technically unreachable!
+}
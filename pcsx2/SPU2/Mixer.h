@@ -126,7 +126,9 @@ struct FrequencyResponseFilter
 	}
 };
 
-extern void Mix();
+// Mixes up to 'count' samples back to back, advancing Cycles for each.  Stops early after
+// a sample that raises an SPU2 IRQ.  Returns the number of samples mixed.
+extern uint MixBlock(uint count);
 extern s32 clamp_mix(s32 x, u8 bitshift = 0);
 
 extern StereoOut32 clamp_mix(const StereoOut32& sample, u8 bitshift = 0);
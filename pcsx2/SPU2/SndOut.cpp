@@ -0,0 +1,67 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Global.h"
+
+StereoOut16 SndBuffer::m_packet[SndOutPacketSize];
+int SndBuffer::m_packetPos = 0;
+
+StereoOut16 SndBuffer::m_ring[SndBuffer::RingSize];
+std::atomic<int> SndBuffer::m_wpos(0);
+std::atomic<int> SndBuffer::m_rpos(0);
+
+void SndBuffer::Init()
+{
+	m_packetPos = 0;
+	m_wpos.store(0, std::memory_order_relaxed);
+	m_rpos.store(0, std::memory_order_relaxed);
+}
+
+void SndBuffer::_CommitPacket()
+{
+	m_packetPos = 0;
+
+	const int wpos = m_wpos.load(std::memory_order_relaxed);
+	const int next = (wpos + SndOutPacketSize) & RingMask;
+
+	// The frontend has fallen a whole ring behind (paused, or not running frames while we
+	// are): drop the packet rather than overwrite audio that hasn't been delivered yet.
+	if (next == m_rpos.load(std::memory_order_acquire))
+		return;
+
+	memcpy(&m_ring[wpos], m_packet, sizeof(m_packet));
+	m_wpos.store(next, std::memory_order_release);
+}
+
+void SndBuffer::Flush(retro_audio_sample_batch_t batch_cb)
+{
+	const int wpos = m_wpos.load(std::memory_order_acquire);
+	int rpos = m_rpos.load(std::memory_order_relaxed);
+
+	if (rpos == wpos)
+		return;
+
+	if (wpos < rpos)
+	{
+		batch_cb((const int16_t*)&m_ring[rpos], RingSize - rpos);
+		rpos = 0;
+	}
+
+	if (wpos > rpos)
+		batch_cb((const int16_t*)&m_ring[rpos], wpos - rpos);
+
+	m_rpos.store(wpos, std::memory_order_release);
+}
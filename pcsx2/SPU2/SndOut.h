@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <atomic>
+
 // Number of stereo samples per SndOut block.
 // All drivers must work in units of this size when communicating with
 // SndOut.
@@ -556,6 +558,44 @@ struct Stereo51Out32
 	}
 };
 
+// --------------------------------------------------------------------------------------
+//  SndBuffer
+// --------------------------------------------------------------------------------------
+// Hand-off between the mixer, which produces one sample per MixSample() on the core thread, and
+// the libretro frontend thread.  Samples are gathered into a packet of SndOutPacketSize
+// and published to a ring as a whole; retro_run then delivers everything queued through a
+// single audio batch callback instead of one callback per sample.
+class SndBuffer
+{
+private:
+	static const int RingPackets = 128; // ~170ms of audio at 48KHz
+	static const int RingSize = SndOutPacketSize * RingPackets;
+	static const int RingMask = RingSize - 1;
+
+	static StereoOut16 m_packet[SndOutPacketSize];
+	static int m_packetPos;
+
+	static StereoOut16 m_ring[RingSize];
+	static std::atomic<int> m_wpos; // written by the core thread only
+	static std::atomic<int> m_rpos; // written by the frontend thread only
+
+	static void _CommitPacket();
+
+public:
+	static void Init();
+
+	// Core thread: queues one output sample.
+	static __fi void Write(const StereoOut16& sample)
+	{
+		m_packet[m_packetPos] = sample;
+		if (++m_packetPos == SndOutPacketSize)
+			_CommitPacket();
+	}
+
+	// Frontend thread: delivers every complete packet queued so far.
+	static void Flush(retro_audio_sample_batch_t batch_cb);
+};
+
 // =====================================================================================================
 
 extern void RecordStart(std::wstring* filename);
@@ -511,6 +511,8 @@ extern s16* spu2regs;
 extern s16* _spu2mem;
 extern int PlayMode;
 
+// Set by SetIrqCall, serviced by TimeUpdate before the next tick.
+extern bool has_to_call_irq;
 extern void SetIrqCall(int core);
 extern void StartVoices(int core, u32 value);
 extern void StopVoices(int core, u32 value);
@@ -551,4 +553,36 @@ struct PcmCacheEntry
 	s16 Sampledata[pcm_DecodedSamplesPerBlock];
 };
 
-extern PcmCacheEntry* pcm_cache_data;
+// The cache is committed in pages as the mixer first touches them, since games only ever
+// play from a fraction of SPU2 ram.  A page covers 4KB of SPU2 ram (256 ADPCM blocks) and
+// stays put until shutdown, so voices can keep SBuffer pointers into it.
+static const int pcm_BlocksPerPage = 256;
+static const int pcm_PageCount = pcm_BlockCount / pcm_BlocksPerPage;
+
+struct PcmCachePage
+{
+	PcmCacheEntry Blocks[pcm_BlocksPerPage];
+};
+
+extern PcmCachePage* pcm_cache_pages[pcm_PageCount];
+
+extern PcmCachePage* CommitPcmCachePage(int pageIdx);
+extern void WipePcmCache();
+extern void ReleasePcmCache();
+extern void ReportPcmCacheStats();
+
+// Returns the cache entry of an ADPCM block, committing its page if needed.
+static __forceinline PcmCacheEntry& GetPcmCacheEntry(int cacheIdx)
+{
+	PcmCachePage* page = pcm_cache_pages[cacheIdx / pcm_BlocksPerPage];
+	if (page == nullptr)
+		page = CommitPcmCachePage(cacheIdx / pcm_BlocksPerPage);
+	return page->Blocks[cacheIdx % pcm_BlocksPerPage];
+}
+
+// Blocks of uncommitted pages were never decoded, so there's nothing to invalidate.
+static __forceinline void InvalidatePcmCacheEntry(int cacheIdx)
+{
+	if (PcmCachePage* page = pcm_cache_pages[cacheIdx / pcm_BlocksPerPage])
+		page->Blocks[cacheIdx % pcm_BlocksPerPage].Validated = false;
+}
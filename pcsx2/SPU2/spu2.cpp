@@ -21,8 +21,6 @@
 #include "Utilities/pxStreams.h"
 #include "AppCoreThread.h"
 
-extern retro_audio_sample_t sample_cb;
-
 int Interpolation = 4;
 unsigned int delayCycles = 4;
 
@@ -167,15 +165,11 @@ s32 SPU2init()
 	_spu2mem = (s16*)malloc(0x200000);
 
 	// adpcm decoder cache:
-	//  the cache data size is determined by taking the number of adpcm blocks
-	//  (2MB / 16) and multiplying it by the decoded block size (28 samples).
-	//  Thus: pcm_cache_data = 7,340,032 bytes (ouch!)
-	//  Expanded: 16 bytes expands to 56 bytes [3.5:1 ratio]
-	//    Resulting in 2MB * 3.5.
-
-	pcm_cache_data = (PcmCacheEntry*)calloc(pcm_BlockCount, sizeof(PcmCacheEntry));
+	//  a fully committed cache takes the number of adpcm blocks (2MB / 16) times the
+	//  decoded block size (28 samples), about 7MB [16 bytes expand to 56, 3.5:1 ratio].
+	//  Pages are committed by the mixer as it plays from them instead (see GetPcmCacheEntry).
 
-	if ((spu2regs == nullptr) || (_spu2mem == nullptr) || (pcm_cache_data == nullptr))
+	if ((spu2regs == nullptr) || (_spu2mem == nullptr))
 		return -1;
 
 	// Patch up a copy of regtable that directly maps "nullptrs" to SPU2 memory.
@@ -192,6 +186,7 @@ s32 SPU2init()
 	SPU2reset();
 
 	InitADSR();
+	SndBuffer::Init();
 
 	return 0;
 }
@@ -213,7 +208,9 @@ void SPU2shutdown()
 
 	safe_free(spu2regs);
 	safe_free(_spu2mem);
-	safe_free(pcm_cache_data);
+
+	ReportPcmCacheStats();
+	ReleasePcmCache();
 }
 
 void SPU2async(u32 cycles)
@@ -28,7 +28,7 @@ namespace SPU2Savestate
 
 	static void wipe_the_cache()
 	{
-		memset(pcm_cache_data, 0, pcm_BlockCount * sizeof(PcmCacheEntry));
+		WipePcmCache();
 	}
 } // namespace SPU2Savestate
 
@@ -129,7 +129,7 @@ s32 __fastcall SPU2Savestate::ThawIt(DataBlock& spud)
 			for (int v = 0; v < 24; v++)
 			{
 				const int cacheIdx = Cores[c].Voices[v].NextA / pcm_WordsPerBlock;
-				Cores[c].Voices[v].SBuffer = pcm_cache_data[cacheIdx].Sampledata;
+				Cores[c].Voices[v].SBuffer = GetPcmCacheEntry(cacheIdx).Sampledata;
 			}
 		}
 
@@ -76,7 +76,7 @@ __forceinline void spu2M_Write(u32 addr, s16 value)
 	if (addr >= SPU2_DYN_MEMLINE)
 	{
 		const int cacheIdx = addr / pcm_WordsPerBlock;
-		pcm_cache_data[cacheIdx].Validated = false;
+		InvalidatePcmCacheEntry(cacheIdx);
 	}
 	*GETMEMPTR(addr) = value;
 }
@@ -297,6 +297,14 @@ void V_Voice::Stop()
 uint TickInterval = 768;
 static const int SanityInterval = 4800;
 
+// Number of ticks a pending DMA interrupt counter can be decremented by without expiring.
+static __forceinline u32 TicksBeforeDMAExpires(const V_Core& core)
+{
+	if (core.DMAICounter <= 0)
+		return UINT32_MAX - 1;
+	return (core.DMAICounter - 1) / TickInterval;
+}
+
 __forceinline void TimeUpdate(u32 cClocks)
 {
 	u32 dClocks = cClocks - lClocks;
@@ -367,14 +375,26 @@ __forceinline void TimeUpdate(u32 cClocks)
 			}
 		}
 
-		dClocks -= TickInterval;
-		lClocks += TickInterval;
-		Cycles++;
+		// The ticks after this one can be mixed in a single run as long as neither DMA
+		// counter expires during them; MixBlock itself stops once an IRQ becomes pending.
+		u32 ticks = dClocks / TickInterval;
+		ticks = std::min(ticks, 1 + std::min(TicksBeforeDMAExpires(Cores[0]), TicksBeforeDMAExpires(Cores[1])));
+
+		const u32 mixed = MixBlock(ticks);
+
+		// Catch the DMA counters up on the ticks of the run past the first one.
+		const u32 runClocks = (mixed - 1) * TickInterval;
+		for (int i = 0; i < 2; i++)
+		{
+			if (Cores[i].DMAICounter > 0)
+			{
+				Cores[i].DMAICounter -= runClocks;
+				Cores[i].MADR += runClocks << 1;
+			}
+		}
 
-		// Note: IOP does not use MMX regs, so no need to save them.
-		//SaveMMXRegs();
-		Mix();
-		//RestoreMMXRegs();
+		dClocks -= mixed * TickInterval;
+		lClocks += mixed * TickInterval;
 	}
 }
 
@@ -30,6 +30,7 @@
 
 #include "Utilities/SafeArray.inl"
 #include "SPU2/spu2.h"
+#include "PAD/PAD.h"
 
 using namespace R5900;
 
@@ -74,6 +75,11 @@ SaveStateBase::SaveStateBase( SafeArray<u8>* memblock )
 	Init( memblock );
 }
 
+SaveStateBase::SaveStateBase()
+{
+	Init( NULL );
+}
+
 void SaveStateBase::Init( SafeArray<u8>* memblock )
 {
 	m_memory	= memblock;
@@ -95,6 +101,14 @@ void SaveStateBase::PrepBlock( int size )
 	}
 }
 
+u8* SaveStateBase::ReserveBlock( int size )
+{
+	PrepBlock( size );
+	u8* block = GetBlockPtr();
+	CommitBlock( size );
+	return block;
+}
+
 void SaveStateBase::FreezeTag( const char* src )
 {
 	const uint allowedlen = sizeof( m_tagspace )-1;
@@ -148,11 +162,19 @@ SaveStateBase& SaveStateBase::FreezeMainMemory()
 {
 	vu1Thread.WaitVU(); // Finish VU1 just in-case...
 	if (IsLoading()) PreLoadPrep();
-	else m_memory->MakeRoomFor( m_idx + MainMemorySizeInBytes );
+	else if (m_memory) m_memory->MakeRoomFor( m_idx + MainMemorySizeInBytes );
 
 	// First Block - Memory Dumps
 	// ---------------------------
 	FreezeMem(eeMem->Main,		Ps2MemSize::MainRam);		// 32 MB main memory
+	FreezeSmallMemory();
+
+	return *this;
+}
+
+// Everything from the memory dump block except EE main memory.
+void SaveStateBase::FreezeSmallMemory()
+{
 	FreezeMem(eeMem->Scratch,	Ps2MemSize::Scratch);		// scratch pad
 	FreezeMem(eeHw,				Ps2MemSize::Hardware);		// hardware memory
 
@@ -164,8 +186,6 @@ SaveStateBase& SaveStateBase::FreezeMainMemory()
 
 	FreezeMem(vuRegs[1].Micro,	VU1_PROGSIZE);
 	FreezeMem(vuRegs[1].Mem,	VU1_MEMSIZE);
-	
-	return *this;
 }
 
 SaveStateBase& SaveStateBase::FreezeInternals()
@@ -234,12 +254,41 @@ SaveStateBase& SaveStateBase::FreezeInternals()
 	return *this;
 }
 
+// Each plugin block is stored as its size followed by the plugin's own data, so that a
+// plugin which has nothing to save (size 0) costs nothing on either side.
+void SaveStateBase::pluginFreeze( const char* name, s32 (*freezer)(int mode, freezeData* data) )
+{
+	FreezeTag( name );
+
+	freezeData fP = { 0, NULL };
+	if (IsSaving() && freezer( FREEZE_SIZE, &fP ) != 0)
+		fP.size = 0;
+
+	Freeze( fP.size );
+	if (!fP.size) return;
+
+	fP.data = (s8*)ReserveBlock( fP.size );
+	if (!fP.data) return;
+
+	if (freezer( IsSaving() ? FREEZE_SAVE : FREEZE_LOAD, &fP ) != 0)
+		log_cb(RETRO_LOG_ERROR, "Savestate: %s failed to %s its state\n", name, IsSaving() ? "save" : "load");
+}
+
+SaveStateBase& SaveStateBase::FreezePlugins()
+{
+	pluginFreeze( "GS", gsSafeFreeze );
+	pluginFreeze( "SPU2", SPU2freeze );
+	pluginFreeze( "PAD", PADfreeze );
+
+	return *this;
+}
+
 SaveStateBase& SaveStateBase::FreezeAll()
 {
 	FreezeMainMemory();
 	FreezeBios();
 	FreezeInternals();
-	//TODO: ADD BACK FREEZE PLUGINS HERE
+	FreezePlugins();
 	
 	return *this;
 }
@@ -306,3 +355,162 @@ void memLoadingState::FreezeMem( void* data, int size )
 	m_idx += size;
 	memcpy( data, src, size );
 }
+
+// --------------------------------------------------------------------------------------
+//  memFixedSavingState  (implementations)
+// --------------------------------------------------------------------------------------
+memFixedSavingState::memFixedSavingState( void* dest, size_t size )
+{
+	m_dest		= (u8*)dest;
+	m_size		= (int)size;
+	m_overflow	= false;
+}
+
+void memFixedSavingState::FreezeMem( void* data, int size )
+{
+	if (!size) return;
+
+	if (m_dest)
+	{
+		if (m_idx + size <= m_size)
+			memcpy( m_dest + m_idx, data, size );
+		else
+			m_overflow = true;
+	}
+	m_idx += size;
+}
+
+u8* memFixedSavingState::ReserveBlock( int size )
+{
+	u8* block = (m_dest && (m_idx + size <= m_size)) ? (m_dest + m_idx) : NULL;
+	if (m_dest && !block) m_overflow = true;
+	m_idx += size;
+	return block;
+}
+
+// --------------------------------------------------------------------------------------
+//  memFixedLoadingState  (implementations)
+// --------------------------------------------------------------------------------------
+memFixedLoadingState::memFixedLoadingState( const void* src, size_t size )
+{
+	m_src		= (const u8*)src;
+	m_size		= (int)size;
+	m_overflow	= false;
+}
+
+void memFixedLoadingState::FreezeMem( void* data, int size )
+{
+	if (!size) return;
+
+	if (m_idx + size <= m_size)
+		memcpy( data, m_src + m_idx, size );
+	else
+		m_overflow = true;
+	m_idx += size;
+}
+
+u8* memFixedLoadingState::ReserveBlock( int size )
+{
+	u8* block = (m_idx + size <= m_size) ? const_cast<u8*>(m_src + m_idx) : NULL;
+	if (!block) m_overflow = true;
+	m_idx += size;
+	return block;
+}
+
+// --------------------------------------------------------------------------------------
+//  memDeltaSavingState / memDeltaLoadingState  (implementations)
+// --------------------------------------------------------------------------------------
+// The baseline is a copy of EE main memory as of the last delta save (or load).  Its serial
+// is bumped every time the baseline moves, and recorded in each delta state.
+
+static SafeArray<u8>* s_deltaBaseline = NULL;
+static u32 s_deltaSerial = 0;
+
+void DeltaState_Enable( bool enabled )
+{
+	if (enabled && !s_deltaBaseline)
+		s_deltaBaseline = new SafeArray<u8>( Ps2MemSize::MainRam, L"Delta savestate baseline" );
+	else if (!enabled)
+		safe_delete( s_deltaBaseline );
+
+	mmap_SetDirtyTracking( enabled );
+	++s_deltaSerial;
+}
+
+bool DeltaState_IsEnabled()
+{
+	return s_deltaBaseline != NULL;
+}
+
+memDeltaSavingState::memDeltaSavingState( void* dest, size_t size )
+	: memFixedSavingState( dest, size )
+{
+	m_dirtyPages = 0;
+}
+
+SaveStateBase& memDeltaSavingState::FreezeMainMemory()
+{
+	pxAssert( s_deltaBaseline );
+
+	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+
+	// A sizing pass must leave the baseline alone.
+	if (m_dest)
+	{
+		m_dirtyPages = mmap_CommitDirtyRam( s_deltaBaseline->GetPtr() );
+		++s_deltaSerial;
+	}
+
+	FreezeTag( "DeltaMainMemory" );
+	Freeze( s_deltaSerial );
+	Freeze( m_dirtyPages );
+
+	FreezeSmallMemory();
+
+	return *this;
+}
+
+memDeltaLoadingState::memDeltaLoadingState( const void* src, size_t size )
+	: memFixedLoadingState( src, size )
+{
+	m_stale = false;
+}
+
+SaveStateBase& memDeltaLoadingState::FreezeAll()
+{
+	// A stale state is refused before anything in the VM has been touched.
+	FreezeMainMemory();
+	if (m_stale) return *this;
+
+	FreezeBios();
+	FreezeInternals();
+	FreezePlugins();
+
+	return *this;
+}
+
+SaveStateBase& memDeltaLoadingState::FreezeMainMemory()
+{
+	pxAssert( s_deltaBaseline );
+
+	u32 serial = 0;
+	u32 dirtyPages = 0;
+
+	FreezeTag( "DeltaMainMemory" );
+	Freeze( serial );
+	Freeze( dirtyPages );
+
+	if (m_overflow || serial != s_deltaSerial)
+	{
+		m_stale = true;
+		return *this;
+	}
+
+	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	PreLoadPrep();
+
+	mmap_RevertDirtyRam( s_deltaBaseline->GetPtr() );
+	FreezeSmallMemory();
+
+	return *this;
+}
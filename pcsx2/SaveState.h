@@ -28,11 +28,11 @@
 //  the lower 16 bit value.  IF the change is breaking of all compatibility with old
 //  states, increment the upper 16 bit value, and clear the lower 16 bits to 0.
 
-static const u32 g_SaveVersion = (0x9A1C << 16) | 0x0000;
+static const u32 g_SaveVersion = (0x9A1D << 16) | 0x0000;
 
 // this function is meant to be used in the place of GSfreeze, and provides a safe layer
 // between the GS saving function and the MTGS's needs. :)
-extern s32 CALLBACK gsSafeFreeze( int mode, freezeData *data );
+extern s32 gsSafeFreeze( int mode, freezeData *data );
 
 // --------------------------------------------------------------------------------------
 //  SaveStateBase class
@@ -55,6 +55,12 @@ public:
 	SaveStateBase( VmStateBuffer* memblock );
 	virtual ~SaveStateBase() { }
 
+protected:
+	// For derived classes that don't use a VmStateBuffer (fixed external buffers).
+	SaveStateBase();
+
+public:
+
 	static wxString GetFilename( int slot );
 
 	// Gets the version of savestate that this object is acting on.
@@ -72,6 +78,7 @@ public:
 	virtual SaveStateBase& FreezeMainMemory();
 	virtual SaveStateBase& FreezeBios();
 	virtual SaveStateBase& FreezeInternals();
+	virtual SaveStateBase& FreezePlugins();
 
 	// Loads or saves an arbitrary data type.  Usable on atomic types, structs, and arrays.
 	// For dynamically allocated pointers use FreezeMem instead.
@@ -111,6 +118,11 @@ public:
 		m_idx += size;
 	}
 
+	// Returns a pointer to the next 'size' bytes of the state and advances past them, so
+	// that plugins can freeze directly into (or thaw directly out of) the state memory.
+	// May return NULL if there is no backing memory for the block.
+	virtual u8* ReserveBlock( int size );
+
 	// Freezes an identifier value into the savestate for troubleshooting purposes.
 	// Identifiers can be used to determine where in a savestate that data has become
 	// skewed (if the value does not match then the error occurs somewhere prior to that
@@ -157,12 +169,17 @@ protected:
 
 	void deci2Freeze();
 
+	void pluginFreeze( const char* name, s32 (*freezer)(int mode, freezeData* data) );
+
 	// Save or load PCSX2's global frame counter (g_FrameCount) along with each savestate
 	//
 	// This is to prevent any inaccuracy issues caused by having a different
 	// internal emulation frame count than what it was at the beginning of the
 	// original recording
 	void InputRecordingFreeze();
+
+	// Freezes the memory dumps except EE main memory (see FreezeMainMemory).
+	void FreezeSmallMemory();
 };
 
 // --------------------------------------------------------------------------------------
@@ -204,3 +221,97 @@ public:
 	bool IsFinished() const { return m_idx >= m_memory->GetSizeInBytes(); }
 };
 
+
+// --------------------------------------------------------------------------------------
+//  memFixedSavingState / memFixedLoadingState
+// --------------------------------------------------------------------------------------
+// Uncompressed states that work directly on a caller-owned buffer of fixed size, and never
+// allocate.  These back the libretro serialize interface, which the frontend may call every
+// frame (rewind, run-ahead, netplay).  A saving state constructed with a NULL buffer only
+// measures the size of the state.
+
+class memFixedSavingState : public SaveStateBase
+{
+protected:
+	u8*		m_dest;
+	int		m_size;
+	bool	m_overflow;
+
+public:
+	virtual ~memFixedSavingState() = default;
+	memFixedSavingState( void* dest, size_t size );
+
+	void FreezeMem( void* data, int size );
+	u8* ReserveBlock( int size );
+
+	bool IsSaving() const { return true; }
+
+	// True if the state didn't fit in the destination buffer (contents are incomplete).
+	bool IsOverflowed() const { return m_overflow; }
+};
+
+class memFixedLoadingState : public SaveStateBase
+{
+protected:
+	const u8*	m_src;
+	int			m_size;
+	bool		m_overflow;
+
+public:
+	virtual ~memFixedLoadingState() = default;
+	memFixedLoadingState( const void* src, size_t size );
+
+	void FreezeMem( void* data, int size );
+	u8* ReserveBlock( int size );
+
+	bool IsSaving() const { return false; }
+
+	// True if the state ended before everything was read (the VM state is incomplete).
+	bool IsOverflowed() const { return m_overflow; }
+};
+
+
+// --------------------------------------------------------------------------------------
+//  memDeltaSavingState / memDeltaLoadingState
+// --------------------------------------------------------------------------------------
+// Fixed buffer states which leave out EE main memory, the bulk of a state.  Instead a
+// baseline copy of main memory is kept alongside the VM, and saving only copies the pages
+// written since the previous delta save into it (found by write protecting main memory,
+// see mmap_SetDirtyTracking).  Loading reverts the pages written since then, so a delta
+// state can only be loaded while it is the most recent one saved: the single-frame
+// run-ahead pattern of save, run, load, run.  A state that no longer matches the baseline
+// is refused (IsStale) without touching the VM.
+
+extern void DeltaState_Enable( bool enabled );
+extern bool DeltaState_IsEnabled();
+
+class memDeltaSavingState : public memFixedSavingState
+{
+protected:
+	u32		m_dirtyPages;
+
+public:
+	virtual ~memDeltaSavingState() = default;
+	memDeltaSavingState( void* dest, size_t size );
+
+	SaveStateBase& FreezeMainMemory();
+
+	// Number of main memory pages that were copied into the baseline.
+	uint GetDirtyPageCount() const { return m_dirtyPages; }
+};
+
+class memDeltaLoadingState : public memFixedLoadingState
+{
+protected:
+	bool	m_stale;
+
+public:
+	virtual ~memDeltaLoadingState() = default;
+	memDeltaLoadingState( const void* src, size_t size );
+
+	SaveStateBase& FreezeAll();
+	SaveStateBase& FreezeMainMemory();
+
+	// True if the state was saved against an older baseline and couldn't be loaded.
+	bool IsStale() const { return m_stale; }
+};
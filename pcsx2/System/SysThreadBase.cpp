@@ -124,7 +124,9 @@ void SysThreadBase::Suspend( bool isBlocking )
 //   The previous suspension state; true if the thread was running or false if it was
 //   closed, not running, or paused.
 //
-void SysThreadBase::Pause()
+// A non-blocking pause only posts the request; poll IsPaused() for it to land.
+//
+void SysThreadBase::Pause( bool isBlocking )
 {
 	if( IsSelf() || !IsRunning() ) return;
 
@@ -147,7 +149,7 @@ void SysThreadBase::Pause()
 		m_sem_event.Post();
 	}
 
-	m_RunningLock.Wait();
+	if( isBlocking ) m_RunningLock.Wait();
 }
 
 // Resumes the core execution state, or does nothing is the core is already running.  If
@@ -112,7 +112,7 @@ public:
 
 	virtual void Suspend( bool isBlocking = true );
 	virtual void Resume();
-	virtual void Pause();
+	virtual void Pause( bool isBlocking = true );
 
 protected:
 	virtual void OnStart();
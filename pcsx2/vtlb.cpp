@@ -583,6 +583,8 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 	verify(0==(paddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	vtlbdata.vmap_generation++;
+
 	while (size > 0)
 	{
 		VTLBVirtual vmv;
@@ -612,6 +614,8 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	vtlbdata.vmap_generation++;
+
 	uptr bu8 = (uptr)buffer;
 	while (size > 0)
 	{
@@ -627,6 +631,8 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	vtlbdata.vmap_generation++;
+
 	while (size > 0)
 	{
 
@@ -252,10 +252,13 @@ namespace vtlb_private
 
 		u32* ppmap;               //4MB (allocated by vtlb_init) // PS2 virtual to PS2 physical
 
+		u32 vmap_generation;      // bumped whenever vmap changes, for users caching its pointers
+
 		MapData()
 		{
 			vmap = NULL;
 			ppmap = NULL;
+			vmap_generation = 0;
 		}
 	};
 
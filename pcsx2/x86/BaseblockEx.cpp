@@ -17,13 +17,66 @@
 #include "PrecompiledHeader.h"
 #include "BaseblockEx.h"
 
+void BaseBlockLinks::Grow()
+{
+	std::vector<Head> old;
+	old.swap(heads);
+
+	Head empty = { EmptyPC, 0 };
+	heads.assign(old.size() * 2, empty);
+	shift--;
+	used = 0;
+
+	// pcs whose sites were all removed are dropped here
+	for (size_t i = 0; i < old.size(); i++) {
+		if (old[i].pc != EmptyPC && old[i].first) {
+			Find(old[i].pc) = old[i];
+			used++;
+		}
+	}
+}
+
+void BaseBlockLinks::Add(u32 pc, uptr jumpptr)
+{
+	if ((used + 1) * 2 > heads.size())
+		Grow();
+
+	Head& head = Find(pc);
+	if (head.pc == EmptyPC) {
+		head.pc = pc;
+		head.first = 0;
+		used++;
+	}
+
+	Site site = { jumpptr, head.first };
+	sites.push_back(site);
+	head.first = sites.size();
+}
+
+void BaseBlockLinks::Remove(u32 pc, uptr jumpptr)
+{
+	Head& head = Find(pc);
+	for (u32* i = &head.first; *i; i = &sites[*i - 1].next) {
+		if (sites[*i - 1].jumpptr == jumpptr) {
+			*i = sites[*i - 1].next;
+			return;
+		}
+	}
+}
+
+void BaseBlockLinks::Clear()
+{
+	Head empty = { EmptyPC, 0 };
+	std::fill(heads.begin(), heads.end(), empty);
+	sites.clear();
+	used = 0;
+}
+
 BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
-	std::pair<linkiter_t, linkiter_t> range = links.equal_range(startpc);
-	for (linkiter_t i = range.first; i != range.second; ++i)
-		*(u32*)i->second = fnptr - (i->second + 4);
-	
-	return blocks.insert(startpc, fnptr);;
+	links.Patch(startpc, fnptr);
+
+	return blocks.insert(startpc, fnptr);
 }
 
 int BaseBlocks::LastIndex(u32 startpc) const
@@ -77,6 +130,10 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 		*jumpptr = (s32)(targetblock->fnptr - (sptr)(jumpptr + 1));
 	else
 		*jumpptr = (s32)(recompiler - (sptr)(jumpptr + 1));
-	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
+	links.Add(pc, (uptr)jumpptr);
 }
 
+void BaseBlocks::Unlink(u32 pc, s32* jumpptr)
+{
+	links.Remove(pc, (uptr)jumpptr);
+}
@@ -15,7 +15,7 @@
 
 #pragma once
 
-#include <map>			// used by BaseBlockEx
+#include <vector>		// used by BaseBlockLinks
 
 // Every potential jump point in the PS2's addressable memory has a BASEBLOCK
 // associated with it. So that means a BASEBLOCK for every 4 bytes of PS2
@@ -140,13 +140,74 @@ public:
 	}
 };
 
+// Jump sites waiting on a block start, patched whenever a block is compiled
+// or cleared there.  The sites live in one flat pool, chained per target pc,
+// and the chain heads sit in an open addressing table, so neither adding a
+// site nor finding the sites of a pc touches the heap in the common case.
+class BaseBlockLinks
+{
+	static const u32 EmptyPC = 0xffffffff; // pcs are word aligned
+
+	struct Site
+	{
+		uptr jumpptr;
+		u32  next; // index + 1 of the next site for the same pc, 0 ends the chain
+	};
+
+	struct Head
+	{
+		u32 pc;
+		u32 first; // index + 1 of the newest site, 0 when there is none
+	};
+
+	std::vector<Site> sites;
+	std::vector<Head> heads; // size is a power of 2
+	u32 shift;               // 32 - log2(heads.size())
+	u32 used;
+
+	// Fibonacci hashing: the well mixed bits of the product are the high ones.
+	__fi u32 Hash(u32 pc) const { return ((pc >> 2) * 0x9E3779B1u) >> shift; }
+
+	// Returns the head of pc, or the empty slot it would go to.
+	__fi Head& Find(u32 pc)
+	{
+		u32 mask = heads.size() - 1;
+		for (u32 i = Hash(pc);; i = (i + 1) & mask) {
+			if (heads[i].pc == pc || heads[i].pc == EmptyPC)
+				return heads[i];
+		}
+	}
+
+	void Grow();
+
+public:
+	BaseBlockLinks() : shift(32 - 12), used(0)
+	{
+		Head empty = { EmptyPC, 0 };
+		heads.assign(0x1000, empty);
+		sites.reserve(0x4000);
+	}
+
+	void Add(u32 pc, uptr jumpptr);
+	void Remove(u32 pc, uptr jumpptr);
+
+	// Points every jump waiting on pc at target.
+	__fi void Patch(u32 pc, uptr target)
+	{
+		const Head& head = Find(pc);
+		for (u32 i = head.first; i; i = sites[i - 1].next) {
+			uptr jumpptr = sites[i - 1].jumpptr;
+			*(u32*)jumpptr = target - (jumpptr + 4);
+		}
+	}
+
+	void Clear();
+};
+
 class BaseBlocks
 {
 protected:
-	typedef std::multimap<u32, uptr>::iterator linkiter_t;
-
-	// switch to a hash map later?
-	std::multimap<u32, uptr> links;
+	BaseBlockLinks links;
 	uptr recompiler;
 	BaseBlockArray blocks;
 
@@ -197,11 +258,7 @@ public:
 		do{
 			pxAssert(idx <= last);
 
-			//u32 startpc = blocks[idx].startpc;
-			std::pair<linkiter_t, linkiter_t> range = links.equal_range(blocks[idx].startpc);
-			for (linkiter_t i = range.first; i != range.second; ++i)
-				*(u32*)i->second = recompiler - (i->second + 4);
-
+			links.Patch(blocks[idx].startpc, recompiler);
 		}
 		while(idx++ < last);
 
@@ -210,11 +267,14 @@ public:
 	}
 
 	void Link(u32 pc, s32* jumpptr);
+	// Forgets a jump registered with Link(), for code that is being discarded
+	// before the emitter overwrites it.
+	void Unlink(u32 pc, s32* jumpptr);
 
 	__fi void Reset()
 	{
 		blocks.clear();
-		links.clear();
+		links.Clear();
 	}
 };
 
@@ -0,0 +1,272 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "R5900OpcodeTables.h"
+#include "iR5900.h"
+#include "DebugTools/SymbolMap.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+using namespace x86Emitter;
+
+eeProfiler EE::Profiler;
+
+// The recompiled code increments these directly, so they live in static storage
+// (addressable from the rec cache) instead of on the heap.
+
+struct eeBlockStats {
+	u32 startpc;
+	u32 size; // in instructions
+	u64 hits;
+};
+
+struct eeMemStats {
+	u64 total;     // vtlb accesses
+	u64 fast;      // vtlb accesses that took the direct path
+	u64 constFast; // constant address, direct memory
+	u64 constSlow; // constant address, handler call
+};
+
+static const u32 eeProfBlocks = 1 << 18; // Blocks compiled between two rec resets
+static const u32 eeProfOps    = 512;     // More than there are in the opcode tables
+
+static __aligned16 eeBlockStats s_blocks[eeProfBlocks + 1]; // Last one takes the overflow
+static __aligned16 eeMemStats s_mem[eeProfOps];
+static u32 s_blockCount = 0;
+static eeBlockStats* s_curBlock = NULL;
+static eeMemStats* s_curOp = NULL;
+
+// Not referenced by recompiled code
+static std::map<const R5900::OPCODE*, u32> s_opIndex;
+static const R5900::OPCODE* s_ops[eeProfOps];
+static std::map<u32, eeBlockStats> s_retired; // Blocks of previous rec resets, by startpc
+
+static std::atomic<bool> s_enabled(false);
+static std::atomic<bool> s_resetRequest(false);
+static bool s_recording = false; // EE thread: the block being compiled gets counters
+
+// The tables above are filled on the EE thread and read by Print() from any thread.
+static std::mutex s_lock;
+
+static void EmitCount(u64& counter)
+{
+	xADD(ptr64[&counter], 1);
+}
+
+static void Retire(const eeBlockStats& block)
+{
+	if (!block.hits)
+		return;
+	eeBlockStats& sum = s_retired[block.startpc];
+	sum.startpc = block.startpc;
+	sum.size    = std::max(sum.size, block.size);
+	sum.hits   += block.hits;
+}
+
+static void ClearBlocks()
+{
+	memset(s_blocks, 0, s_blockCount * sizeof(eeBlockStats));
+	memzero(s_blocks[eeProfBlocks]);
+	s_blockCount = 0;
+}
+
+void eeProfiler::SetEnabled(bool enabled)
+{
+	if (s_enabled == enabled)
+		return;
+
+	if (enabled) {
+		std::lock_guard<std::mutex> lock(s_lock);
+		// Start from scratch.  Counters of code that's still around may tick until the
+		// recompiler resets; those counts are dropped along with its blocks.
+		s_retired.clear();
+		ClearBlocks();
+		memzero(s_mem);
+	}
+
+	s_enabled = enabled;
+	s_resetRequest = true;
+
+	if (!enabled)
+		Print();
+}
+
+bool eeProfiler::IsEnabled() const
+{
+	return s_enabled;
+}
+
+bool eeProfiler::TakeResetRequest()
+{
+	return s_resetRequest.exchange(false);
+}
+
+void eeProfiler::Reset()
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	if (s_enabled) {
+		for (u32 i = 0; i < s_blockCount; i++)
+			Retire(s_blocks[i]);
+	}
+	ClearBlocks();
+	s_curBlock = NULL;
+}
+
+void eeProfiler::EmitBlock(u32 startpc)
+{
+	s_recording = s_enabled;
+	if (!s_recording) {
+		s_curBlock = NULL;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_lock);
+	s_curBlock = &s_blocks[std::min(s_blockCount, eeProfBlocks)];
+	if (s_blockCount < eeProfBlocks) {
+		s_curBlock->startpc = startpc;
+		s_blockCount++;
+	}
+	EmitCount(s_curBlock->hits);
+}
+
+void eeProfiler::EndBlock(u32 endpc)
+{
+	if (s_curBlock && s_curBlock != &s_blocks[eeProfBlocks])
+		s_curBlock->size = (endpc - s_curBlock->startpc) / 4;
+	s_curBlock = NULL;
+	s_recording = false;
+}
+
+void eeProfiler::EmitOp(const R5900::OPCODE* op)
+{
+	if (!op || !s_recording) {
+		s_curOp = NULL;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_lock);
+	auto it = s_opIndex.find(op);
+	if (it == s_opIndex.end()) {
+		if (s_opIndex.size() >= eeProfOps) {
+			s_curOp = NULL;
+			return;
+		}
+		s_ops[s_opIndex.size()] = op;
+		it = s_opIndex.emplace(op, s_opIndex.size()).first;
+	}
+	s_curOp = &s_mem[it->second];
+}
+
+// Memory counters go in right before/after flag-setting code of the vtlb
+// lookup, where the flags are dead.
+void eeProfiler::EmitMem()
+{
+	if (s_curOp) EmitCount(s_curOp->total);
+}
+
+void eeProfiler::EmitFastMem()
+{
+	if (s_curOp) EmitCount(s_curOp->fast);
+}
+
+void eeProfiler::EmitConstMem(u32 add)
+{
+	if (s_curOp) EmitCount(s_curOp->constFast);
+}
+
+void eeProfiler::EmitSlowMem()
+{
+	if (s_curOp) EmitCount(s_curOp->constSlow);
+}
+
+static std::string SymbolName(u32 pc)
+{
+	u32 start = symbolMap.GetFunctionStart(pc);
+	if (start == SymbolMap::INVALID_ADDRESS)
+		return "?";
+	std::string label = symbolMap.GetLabelString(start);
+	if (label.empty())
+		return "?";
+	if (pc != start) {
+		char offset[16];
+		snprintf(offset, sizeof(offset), "+0x%x", pc - start);
+		label += offset;
+	}
+	return label;
+}
+
+void eeProfiler::Print()
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	std::map<u32, eeBlockStats> blocks(s_retired);
+	for (u32 i = 0; i < s_blockCount; i++) {
+		if (!s_blocks[i].hits)
+			continue;
+		eeBlockStats& sum = blocks[s_blocks[i].startpc];
+		sum.startpc = s_blocks[i].startpc;
+		sum.size    = std::max(sum.size, s_blocks[i].size);
+		sum.hits   += s_blocks[i].hits;
+	}
+
+	if (blocks.empty())
+		return;
+
+	// Blocks by the number of instructions they ran
+	std::vector<eeBlockStats> sorted;
+	u64 totalInsts = 0;
+	for (const auto& it : blocks) {
+		sorted.push_back(it.second);
+		totalInsts += it.second.hits * it.second.size;
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const eeBlockStats& a, const eeBlockStats& b) {
+		return a.hits * a.size > b.hits * b.size;
+	});
+
+	log_cb(RETRO_LOG_INFO, "EE profile: %zu blocks, %llu instructions run (%llu hits in overflow)\n",
+		sorted.size(), (unsigned long long)totalInsts, (unsigned long long)s_blocks[eeProfBlocks].hits);
+	log_cb(RETRO_LOG_INFO, "  %-8s  %-40s %14s %6s %7s\n", "pc", "symbol", "hits", "insts", "share");
+	for (size_t i = 0; i < std::min<size_t>(sorted.size(), 100); i++) {
+		const eeBlockStats& b = sorted[i];
+		log_cb(RETRO_LOG_INFO, "  %08x  %-40s %14llu %6u %6.2f%%\n", b.startpc, SymbolName(b.startpc).c_str(),
+			(unsigned long long)b.hits, b.size, totalInsts ? 100.0 * b.hits * b.size / totalInsts : 0.0);
+	}
+
+	// Opcodes by the number of memory accesses
+	std::vector<std::pair<const R5900::OPCODE*, const eeMemStats*>> ops;
+	for (u32 i = 0; i < s_opIndex.size(); i++) {
+		const eeMemStats& m = s_mem[i];
+		if (m.total + m.constFast + m.constSlow)
+			ops.emplace_back(s_ops[i], &m);
+	}
+	std::sort(ops.begin(), ops.end(), [](const std::pair<const R5900::OPCODE*, const eeMemStats*>& a,
+	                                     const std::pair<const R5900::OPCODE*, const eeMemStats*>& b) {
+		return a.second->total + a.second->constFast + a.second->constSlow > b.second->total + b.second->constFast + b.second->constSlow;
+	});
+
+	log_cb(RETRO_LOG_INFO, "EE memory accesses per opcode:\n");
+	log_cb(RETRO_LOG_INFO, "  %-8s %14s %14s %14s %14s\n", "opcode", "fast", "slow", "const fast", "const slow");
+	for (const auto& op : ops) {
+		const eeMemStats& m = *op.second;
+		log_cb(RETRO_LOG_INFO, "  %-8s %14llu %14llu %14llu %14llu\n", op.first->Name,
+			(unsigned long long)m.fast, (unsigned long long)(m.total - m.fast),
+			(unsigned long long)m.constFast, (unsigned long long)m.constSlow);
+	}
+}
@@ -221,12 +221,38 @@ static const char eeOpcodeName[][16] = {
 	"!"
 };
 
+// Counts, in the recompiled code, how often each EE block runs and how each opcode's
+// memory accesses resolve (direct vs vtlb handler).  It's switched at runtime with
+// SetEnabled(), which asks the recompiler to reset so the whole cache gets rebuilt with
+// (or without) the counters.  The report is printed when profiling is switched off and
+// at recompiler shutdown, or on demand with Print().
+
+namespace R5900 { struct OPCODE; }
+
 struct eeProfiler {
-	__fi void Reset() {}
-	__fi void EmitOp(eeOpcode op) {}
-	__fi void Print() {}
-	__fi void EmitMem() {}
-	__fi void EmitConstMem(u32 add) {}
-	__fi void EmitSlowMem() {}
-	__fi void EmitFastMem() {}
+	// Any thread.  Enabling starts a new profile, disabling prints it.
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const;
+	void Print();
+
+	// EE thread, when a block gets compiled: true once after SetEnabled() changed the state.
+	bool TakeResetRequest();
+
+	// Recompiler reset: the old code is gone, keep what it counted
+	void Reset();
+
+	// Block hit counter, emitted at the start of the block's code
+	void EmitBlock(u32 startpc);
+	void EndBlock(u32 endpc);
+
+	// Memory accesses are counted against the opcode being recompiled (NULL: none)
+	void EmitOp(const R5900::OPCODE* op);
+	void EmitMem();             // vtlb access, before the fast/slow split
+	void EmitFastMem();         // vtlb access that took the direct path
+	void EmitConstMem(u32 add); // constant address, direct memory
+	void EmitSlowMem();         // constant address, handler call
 };
+
+namespace EE {
+	extern eeProfiler Profiler;
+}
@@ -38,6 +38,9 @@
 #	include <csetjmp>
 #endif
 
+#include <unordered_map>
+#include <unordered_set>
+
 
 #include "Utilities/MemsetFast.inl"
 
@@ -100,10 +103,48 @@ static EEINST* s_psaveInstInfo = NULL;
 
 static u32 s_savenBlockCycles = 0;
 
+// Superblocks: a block ending in a conditional branch counts its executions,
+// and once hot it is recompiled together with the fall-through path of its
+// conditional branches.  Guest registers held by the allocator and known
+// constants then stay live where the block used to end.
+static const u32 SUPERBLOCK_THRESHOLD = 1024;
+static const u32 SUPERBLOCK_MAX_BRANCHES = 8;
+static const u32 SUPERBLOCK_COUNTERS = 0x8000;
+
+// static so that recompiled code can address the counters directly
+static u32 s_hotCounters[SUPERBLOCK_COUNTERS];
+static u32 s_hotCountersUsed = 0;
+static std::unordered_set<u32> s_hotBlocks;
+static bool s_nSuperblock;
+// Lowest superblock start touching each 4k page, keyed by page (see recClear)
+static std::unordered_map<u32, u32> s_superblockFloor;
+
+// The exit last emitted by SetBranchImm() and the allocator state before it,
+// so that a superblock can take it back when it only leads to the next
+// instruction.
+static struct
+{
+	u8* start;
+	u8* end;
+	s32* link;
+	u32 imm;
+	u32 hasConstReg, flushedConstReg;
+	bool flushedPC, flushedCode, maySignalException;
+	_x86regs x86[iREGCNT_GPR];
+	_xmmregs xmm[iREGCNT_XMM];
+} s_lastExit;
+
 static void iBranchTest(u32 newpc = 0xffffffff);
 static void ClearRecLUT(BASEBLOCK* base, int count);
 static u32 scaleblockcycles();
 
+// Block scan: whether the conditional branch at branchpc may have its
+// fall-through path compiled into the same block.
+static bool recCanFallThrough(u32 startpc, u32 branchpc)
+{
+	return s_branchTo != startpc && ((branchpc + 8) & 0xffc) != 0;
+}
+
 void _eeFlushAllUnused()
 {
 	u32 i;
@@ -598,6 +639,11 @@ static void recResetRaw()
 
 	recBlocks.Reset();
 	mmap_ResetBlockTracking();
+	EE::Profiler.Reset();
+
+	s_hotCountersUsed = 0;
+	s_hotBlocks.clear();
+	s_superblockFloor.clear();
 
 	x86SetPtr(*recMem);
 
@@ -611,6 +657,9 @@ static void recResetRaw()
 
 static void recShutdown()
 {
+	if (EE::Profiler.IsEnabled())
+		EE::Profiler.Print();
+
 	safe_delete( recMem );
 	safe_aligned_free( recRAMCopy );
 	safe_aligned_free( recLutReserve_RAM );
@@ -764,45 +813,70 @@ void recClear(u32 addr, u32 size)
 	if (blockidx == -1)
 		return;
 
+	// Blocks never overlap each other, except superblocks, which overlap the
+	// blocks they absorbed.  Every block stays within the 4k page it starts in
+	// (give or take a delay slot), so the walk back can stop at the first block
+	// that ends before the range once it is below the lowest superblock start
+	// touching the range's page.
+	u32 floor = addr;
+	auto sb = s_superblockFloor.find(addr >> 12);
+	if (sb != s_superblockFloor.end())
+		floor = std::min(floor, sb->second);
+
 	u32 lowerextent = (u32)-1, upperextent = 0, ceiling = (u32)-1;
 
 	BASEBLOCKEX* pexblock = recBlocks[blockidx + 1];
 	if (pexblock)
 		ceiling = pexblock->startpc;
 
+	for (int i = blockidx; (pexblock = recBlocks[i]); i--) {
+		u32 blockstart = pexblock->startpc;
+		u32 blockend = pexblock->startpc + pexblock->size * 4;
+
+		if (blockend <= addr) {
+			if (blockstart < floor)
+				break;
+			continue;
+		}
+
+		if (PC_GETBLOCK(blockstart) == s_pCurBlock)
+			continue;
+
+		lowerextent = std::min(lowerextent, blockstart);
+		upperextent = std::max(upperextent, blockend);
+	}
+
+	// Drop every block starting inside the extent, including the ones a
+	// superblock absorbed that don't reach the range, since their LUT entries
+	// are about to be cleared.
 	int toRemoveLast = blockidx;
 
-	while (pexblock = recBlocks[blockidx]) {
+	for (; (pexblock = recBlocks[blockidx]); blockidx--) {
 		u32 blockstart = pexblock->startpc;
-		u32 blockend = pexblock->startpc + pexblock->size * 4;
 		BASEBLOCK* pblock = PC_GETBLOCK(blockstart);
 
-		if (pblock == s_pCurBlock) {
+		if (blockstart < lowerextent)
+			break;
+
+		if (pblock == s_pCurBlock || blockstart >= upperextent) {
 			if(toRemoveLast != blockidx) {
 				recBlocks.Remove((blockidx + 1), toRemoveLast);
 			}
-			toRemoveLast = --blockidx;
+			toRemoveLast = blockidx - 1;
 			continue;
 		}
 
-		if (blockend <= addr) {
-			lowerextent = std::max(lowerextent, blockend);
-			break;
-		}
-
-		lowerextent = std::min(lowerextent, blockstart);
-		upperextent = std::max(upperextent, blockend);
 		// This might end up inside a block that doesn't contain the clearing range,
 		// so set it to recompile now.  This will become JITCompile if we clear it.
 		pblock->SetFnptr((uptr)JITCompileInBlock);
-
-		blockidx--;
 	}
 
 	if(toRemoveLast != blockidx) {
 		recBlocks.Remove((blockidx + 1), toRemoveLast);
 	}
 
+	// A superblock may cover blocks past the range; those stay, and so do their
+	// LUT entries.
 	upperextent = std::min(upperextent, ceiling);
 
 	for (int i = 0; pexblock = recBlocks[i]; i++) {
@@ -878,10 +952,61 @@ void SetBranchImm( u32 imm )
 
 	pxAssert( imm );
 
+	if (s_nSuperblock) {
+		s_lastExit.start = xGetPtr();
+		s_lastExit.link = NULL;
+		s_lastExit.imm = imm;
+		s_lastExit.hasConstReg = g_cpuHasConstReg;
+		s_lastExit.flushedConstReg = g_cpuFlushedConstReg;
+		s_lastExit.flushedPC = g_cpuFlushedPC;
+		s_lastExit.flushedCode = g_cpuFlushedCode;
+		s_lastExit.maySignalException = g_maySignalException;
+		memcpy(s_lastExit.x86, x86regs, sizeof(x86regs));
+		memcpy(s_lastExit.xmm, xmmregs, sizeof(xmmregs));
+	}
+
 	// end the current block
 	iFlushCall(FLUSH_EVERYTHING);
 	xMOV(ptr32[&cpuRegs.pc], imm);
 	iBranchTest(imm);
+
+	if (s_nSuperblock)
+		s_lastExit.end = xGetPtr();
+}
+
+// Called after a branch instruction of a superblock.  If the code emitted last
+// is the exit to the instruction following the delay slot, it is discarded and
+// compilation carries on with the allocator state the exit started from.
+static void recFallThrough()
+{
+	if (g_branch != 1 || pc >= s_nEndBlock)
+		return;
+	if (s_lastExit.imm != pc || s_lastExit.end != xGetPtr())
+		return;
+
+	if (s_lastExit.link)
+		recBlocks.Unlink(HWADDR(pc), s_lastExit.link);
+	xSetPtr(s_lastExit.start);
+
+	g_cpuHasConstReg = s_lastExit.hasConstReg;
+	g_cpuFlushedConstReg = s_lastExit.flushedConstReg;
+	g_cpuFlushedPC = s_lastExit.flushedPC;
+	g_cpuFlushedCode = s_lastExit.flushedCode;
+	g_maySignalException = s_lastExit.maySignalException;
+	memcpy(x86regs, s_lastExit.x86, sizeof(x86regs));
+	memcpy(xmmregs, s_lastExit.xmm, sizeof(xmmregs));
+
+	s_lastExit.end = NULL;
+	g_branch = 0;
+}
+
+// Called from a block's execution counter: the next dispatch to startpc
+// recompiles it as a superblock.  The current code stays in place until the
+// next reset, so this execution simply carries on with it.
+static void __fastcall recPromoteBlock(u32 startpc)
+{
+	s_hotBlocks.insert(HWADDR(startpc));
+	recClear(startpc, 1);
 }
 
 void SaveBranchState()
@@ -1057,8 +1182,11 @@ static void iBranchTest(u32 newpc)
 
 		if (newpc == 0xffffffff)
 			xJS( DispatcherReg );
-		else
-			recBlocks.Link(HWADDR(newpc), xJcc32(Jcc_Signed));
+		else {
+			s32* link = xJcc32(Jcc_Signed);
+			recBlocks.Link(HWADDR(newpc), link);
+			s_lastExit.link = link;
+		}
 
 		xJMP( (void*)DispatcherEvent );
 	}
@@ -1356,6 +1484,7 @@ void recompileNextInstruction(int delayslot)
 	else {
 		//If the COP0 DIE bit is disabled, cycles should be doubled.
 		s_nBlockCycles += opcode.cycles * (2 - ((cpuRegs.CP0.n.Config >> 18) & 0x1));
+		EE::Profiler.EmitOp(&opcode);
 		try {
 			opcode.recompile();
 		} catch (Exception::FailedToAllocateRegister&) {
@@ -1366,6 +1495,7 @@ void recompileNextInstruction(int delayslot)
 			//	_freeXMMregs();
 #endif
 		}
+		EE::Profiler.EmitOp(NULL);
 	}
 
 	if (!delayslot && (_getNumXMMwrite() > 2)) _flushXMMunused();
@@ -1609,6 +1739,10 @@ static void __fastcall recRecompile( const u32 startpc )
 		eeRecNeedsReset = true;
 	}
 
+	// Switching the profiler on or off rebuilds the cache with or without its counters.
+	if (EE::Profiler.TakeResetRequest())
+		eeRecNeedsReset = true;
+
 	if (eeRecNeedsReset) recResetRaw();
 
 	xSetPtr( recPtr );
@@ -1709,6 +1843,12 @@ static void __fastcall recRecompile( const u32 startpc )
 	s_nEndBlock = 0xffffffff;
 	s_branchTo = -1;
 
+	s_nSuperblock = s_hotBlocks.count(HWADDR(startpc)) != 0;
+	s_lastExit.end = NULL;
+	u32 fallThroughs = 0;
+	u32 maxFallThroughs = s_nSuperblock ? SUPERBLOCK_MAX_BRANCHES : 0;
+	bool countExecutions = false;
+
 	// compile breakpoints as individual blocks
 	int n1 = isBreakpointNeeded(i);
 	int n2 = isMemcheckNeeded(i);
@@ -1738,7 +1878,8 @@ static void __fastcall recRecompile( const u32 startpc )
 				break;
 			}
 
-			if (pblock->GetFnptr() != (uptr)JITCompile && pblock->GetFnptr() != (uptr)JITCompileInBlock)
+			// superblocks may overlap the blocks they were built from
+			if (!s_nSuperblock && pblock->GetFnptr() != (uptr)JITCompile && pblock->GetFnptr() != (uptr)JITCompileInBlock)
 			{
 				willbranch3 = 1;
 				s_nEndBlock = i;
@@ -1763,6 +1904,17 @@ static void __fastcall recRecompile( const u32 startpc )
 					// branches
 					s_branchTo = _Imm_ * 4 + i + 4;
 					if( s_branchTo > startpc && s_branchTo < i ) s_nEndBlock = s_branchTo;
+					else if( _Rt_ < 2 && recCanFallThrough(startpc, i) ) {
+						// BLTZ, BGEZ
+						if( fallThroughs < maxFallThroughs ) {
+							fallThroughs++;
+							s_branchTo = -1;
+							i += 8;
+							continue;
+						}
+						countExecutions = !s_nSuperblock;
+						s_nEndBlock = i+8;
+					}
 					else  s_nEndBlock = i+8;
 
 					goto StartRecomp;
@@ -1777,6 +1929,23 @@ static void __fastcall recRecompile( const u32 startpc )
 
 			// branches
 			case 4: case 5: case 6: case 7:
+				s_branchTo = _Imm_ * 4 + i + 4;
+				if( s_branchTo > startpc && s_branchTo < i ) s_nEndBlock = s_branchTo;
+				else if( recCanFallThrough(startpc, i) ) {
+					if( fallThroughs < maxFallThroughs ) {
+						fallThroughs++;
+						s_branchTo = -1;
+						i += 8;
+						continue;
+					}
+					countExecutions = !s_nSuperblock;
+					s_nEndBlock = i+8;
+				}
+				else  s_nEndBlock = i+8;
+
+				goto StartRecomp;
+
+			// branch likely
 			case 20: case 21: case 22: case 23:
 				s_branchTo = _Imm_ * 4 + i + 4;
 				if( s_branchTo > startpc && s_branchTo < i ) s_nEndBlock = s_branchTo;
@@ -1962,14 +2131,36 @@ StartRecomp:
 	if (doRecompilation) {
 		// Finally: Generate x86 recompiled code!
 		g_pCurInstInfo = s_pInstCache;
+
+		if (countExecutions && s_hotCountersUsed < SUPERBLOCK_COUNTERS) {
+			u32* counter = &s_hotCounters[s_hotCountersUsed++];
+			*counter = SUPERBLOCK_THRESHOLD;
+
+			xSUB(ptr32[counter], 1);
+			xForwardJNZ8 notHot;
+			xFastCall((void*)recPromoteBlock, startpc);
+			notHot.SetTarget();
+		}
+
+		EE::Profiler.EmitBlock(startpc);
 		while (!g_branch && pc < s_nEndBlock) {
 			recompileNextInstruction(0);		// For the love of recursion, batman!
+			if (s_nSuperblock)
+				recFallThrough();
 		}
+		EE::Profiler.EndBlock(pc);
 	}
 
 	pxAssert( (pc-startpc)>>2 <= 0xffff );
 	s_pCurBlockEx->size = (pc-startpc)>>2;
 
+	if (s_nSuperblock) {
+		for (u32 page = HWADDR(startpc) >> 12; page <= (HWADDR(pc) - 4) >> 12; page++) {
+			auto sb = s_superblockFloor.emplace(page, HWADDR(startpc)).first;
+			sb->second = std::min(sb->second, HWADDR(startpc));
+		}
+	}
+
 	if (HWADDR(pc) <= Ps2MemSize::MainRam) {
 		BASEBLOCKEX *oldBlock;
 		int i;
@@ -2056,6 +2247,7 @@ StartRecomp:
 
 	s_pCurBlock = NULL;
 	s_pCurBlockEx = NULL;
+	s_nSuperblock = false;
 }
 
 // The only *safe* way to throw exceptions from the context of recompiled code.
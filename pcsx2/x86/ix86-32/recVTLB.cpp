@@ -370,9 +370,11 @@ void vtlb_DynGenRead64(u32 bits)
 {
 	pxAssume( bits == 64 || bits == 128 );
 
+	EE::Profiler.EmitMem();
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits );
+	EE::Profiler.EmitFastMem();
 	DynGen_DirectRead( bits, false );
 
 	vtlb_SetWriteback(writeback);		// return target for indirect's call/ret
@@ -386,9 +388,11 @@ void vtlb_DynGenRead32(u32 bits, bool sign)
 {
 	pxAssume( bits <= 32 );
 
+	EE::Profiler.EmitMem();
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
+	EE::Profiler.EmitFastMem();
 	DynGen_DirectRead( bits, sign );
 
 	vtlb_SetWriteback(writeback);
@@ -402,6 +406,7 @@ void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const )
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
+		EE::Profiler.EmitConstMem(addr_const);
 		auto ppf = vmv.assumePtr(addr_const);
 		switch( bits )
 		{
@@ -419,6 +424,7 @@ void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const )
 	else
 	{
 		// has to: translate, find function, call function
+		EE::Profiler.EmitSlowMem();
 		u32 paddr = vmv.assumeHandlerGetPAddr(addr_const);
 
 		int szidx = 0;
@@ -446,6 +452,7 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
+		EE::Profiler.EmitConstMem(addr_const);
 		auto ppf = vmv.assumePtr(addr_const);
 		switch( bits )
 		{
@@ -471,6 +478,7 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 	else
 	{
 		// has to: translate, find function, call function
+		EE::Profiler.EmitSlowMem();
 		u32 paddr = vmv.assumeHandlerGetPAddr(addr_const);
 
 		int szidx = 0;
@@ -516,9 +524,11 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 
 void vtlb_DynGenWrite(u32 sz)
 {
+	EE::Profiler.EmitMem();
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 1, sz );
+	EE::Profiler.EmitFastMem();
 	DynGen_DirectWrite( sz );
 
 	vtlb_SetWriteback(writeback);
@@ -534,6 +544,7 @@ void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const )
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
+		EE::Profiler.EmitConstMem(addr_const);
 		// TODO: x86Emitter can't use dil
 
 		auto ppf = vmv.assumePtr(addr_const);
@@ -566,6 +577,7 @@ void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const )
 	else
 	{
 		// has to: translate, find function, call function
+		EE::Profiler.EmitSlowMem();
 		u32 paddr = vmv.assumeHandlerGetPAddr(addr_const);
 
 		int szidx = 0;
@@ -110,6 +110,10 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVU.prog.x86end		= z + ((mVU.cacheSize - mVUcacheSafeZone) * _1mb);
 	//memset(mVU.prog.x86start, 0xcc, mVU.cacheSize*_1mb);
 
+	if (!mVU.prog.index) mVU.prog.index = new microProgramIndex();
+	mVU.prog.index->clear();
+	mVU.prog.dirtyChunks = ~0ull; // Rehash all of micro memory on the next search
+
 	for(u32 i = 0; i < (mVU.progSize / 2); i++) {
 		if(!mVU.prog.prog[i]) {
 			mVU.prog.prog[i] = new std::deque<microProgram*>();
@@ -141,10 +145,18 @@ void mVUclose(microVU& mVU) {
 		}
 		safe_delete(mVU.prog.prog[i]);
 	}
+	safe_delete(mVU.prog.index);
 }
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size) {
+	// Callers clear before writing, so chunks are only marked here and rehashed on the next search
+	const u32 chunkSize = mVU.microMemSize / mProgChunks;
+	if (size >= mVU.microMemSize) mVU.prog.dirtyChunks = ~0ull;
+	else {
+		for (u32 i = addr / chunkSize; i <= (addr + std::max(size, 1u) - 1) / chunkSize; i++)
+			mVU.prog.dirtyChunks |= 1ull << (i % mProgChunks);
+	}
 	if(!mVU.prog.cleared) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
@@ -181,23 +193,71 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 	prog->ranges  = new std::deque<microRange>();
 	prog->startPC = startPC;
 	mVUcacheProg(mVU, *prog); // Cache Micro Program
+	mVU.prog.misses++;
 	double cacheSize = (double)((uptr)mVU.prog.x86end - (uptr)mVU.prog.x86start);
 	double cacheUsed =((double)((uptr)mVU.prog.x86ptr - (uptr)mVU.prog.x86start)) / (double)_1mb;
 	double cachePerc =((double)((uptr)mVU.prog.x86ptr - (uptr)mVU.prog.x86start)) / cacheSize * 100;
 #ifndef NDEBUG
 	log_cb(RETRO_LOG_DEBUG, "microVU%d: Cached Prog = [%03d] [PC=%04x] [List=%02d] (Cache=%3.3f%%) [%3.1fmb]\n",
 				   mVU.index, prog->idx, startPC*8, mVU.prog.prog[startPC]->size()+1, cachePerc, cacheUsed);
+	log_cb(RETRO_LOG_DEBUG, "microVU%d: Search hits = [hash=%u] [scan=%u] [miss=%u] (Compared=%3.1fmb)\n",
+				   mVU.index, mVU.prog.hashHits, mVU.prog.scanHits, mVU.prog.misses, (double)mVU.prog.bytesCompared / _1mb);
 #endif
 	return prog;
 }
 
+// Hashes one chunk of micro memory
+static __fi u64 mVUhashChunk(const u8* data, u32 size) {
+	u64 hash = 0xcbf29ce484222325ull;
+	for (u32 i = 0; i < size; i += 8) {
+		hash ^= *(u64*)&data[i];
+		hash *= 0x100000001b3ull;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+// Rehashes the chunks of micro memory written since the last search,
+// and returns the hash of the whole micro memory combined with startPC
+static u64 mVUupdateHash(microVU& mVU, u32 startPC) {
+	const u32 chunkSize = mVU.microMemSize / mProgChunks;
+	if (mVU.prog.dirtyChunks) {
+		for (u32 i = 0; i < mProgChunks; i++) {
+			if (mVU.prog.dirtyChunks & (1ull << i))
+				mVU.prog.chunkHash[i] = mVUhashChunk(mVU.regs().Micro + i * chunkSize, chunkSize);
+		}
+		mVU.prog.dirtyChunks = 0;
+	}
+	u64 hash = startPC;
+	for (u32 i = 0; i < mProgChunks; i++) {
+		hash = (hash ^ mVU.prog.chunkHash[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
 // Caches Micro Program
 __ri void mVUcacheProg(microVU& mVU, microProgram& prog) {
 	if (!mVU.index)	memcpy(prog.data, mVU.regs().Micro, 0x1000);
 	else			memcpy(prog.data, mVU.regs().Micro, 0x4000);
+	// prog.data now equals micro memory, index it under the current hash
+	(*mVU.prog.index)[mVUupdateHash(mVU, prog.startPC)] = &prog;
+	memcpy(prog.chunkHash, mVU.prog.chunkHash, sizeof(prog.chunkHash));
 	mVUdumpProg(mVU, prog);
 }
 
+// Returns false if a chunk fully inside the program's ranges has changed since it was cached.
+// Partially covered chunks can't tell, those are left to mVUcmpProg().
+static __fi bool mVUchunksMatch(microVU& mVU, microProgram& prog) {
+	const s32 chunkSize = mVU.microMemSize / mProgChunks;
+	for (const auto& range : *prog.ranges) {
+		for (s32 i = (range.start + chunkSize - 1) / chunkSize; i < range.end / chunkSize; i++) {
+			if (prog.chunkHash[i] != mVU.prog.chunkHash[i])
+				return false;
+		}
+	}
+	return true;
+}
+
 // Generate Hash for partial program based on compiled ranges...
 u64 mVUrangesHash(microVU& mVU, microProgram& prog) {
 	union {
@@ -242,6 +302,7 @@ void mVUprintUniqueRatio(microVU& mVU) {
 __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg) {
 	if (cmpWholeProg)
 	{
+		mVU.prog.bytesCompared += mVU.microMemSize;
 		if (memcmp_mmx((u8*)prog.data, mVU.regs().Micro, mVU.microMemSize))
 			return false;
 	} 
@@ -252,6 +313,7 @@ __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg)
 #ifndef NDEBUG
 			if ((range.start < 0) || (range.end < 0)) { log_cb(RETRO_LOG_DEBUG, "microVU%d: Negative Range![%d][%d]\n", mVU.index, range.start, range.end); }
 #endif
+			mVU.prog.bytesCompared += range.end - range.start;
 			if (memcmp_mmx(cmpOffset(prog.data), cmpOffset(mVU.regs().Micro), (range.end - range.start))) {
 				return false;
 			}
@@ -270,10 +332,24 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microProgramList* list = mVU.prog.prog[mVU.regs().start_pc / 8];
 
 	if(!quick.prog) { // If null, we need to search for new program
+		// A program cached from the exact same micro memory is found by hash,
+		// and only needs its ranges confirmed
+		microProgramIndex::iterator found(mVU.prog.index->find(mVUupdateHash(mVU, mVU.regs().start_pc / 8)));
+		if (found != mVU.prog.index->end() && found->second->startPC == mVU.regs().start_pc / 8 && mVUcmpProg(mVU, *found->second, 0)) {
+			mVU.prog.hashHits++;
+			quick.block = found->second->block[startPC/8];
+			quick.prog  = found->second;
+			if (quick.block == nullptr)
+				return mVUblockFetch(mVU, startPC, pState);
+			return mVUentryGet(mVU, quick.block, startPC, pState);
+		}
+
+		// Otherwise look for a program whose compiled ranges still match
 		std::deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
-			bool b = mVUcmpProg(mVU, *it[0], 0);
+			bool b = mVUchunksMatch(mVU, *it[0]) && mVUcmpProg(mVU, *it[0], 0);
 			if (b) {
+				mVU.prog.scanHits++;
 				quick.block = it[0]->block[startPC/8];
 				quick.prog  = it[0];
 				list->erase(it);
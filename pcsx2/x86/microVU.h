@@ -18,6 +18,7 @@
 using namespace x86Emitter;
 
 #include <deque>
+#include <unordered_map>
 #include <algorithm>
 #include <memory>
 #include "Common.h"
@@ -139,8 +140,10 @@ struct microRange {
 };
 
 #define mProgSize (0x4000/4)
+#define mProgChunks 64 // Micro memory is hashed in this many equal chunks
 struct microProgram {
 	u32				   data [mProgSize];   // Holds a copy of the VU microProgram
+	u64				   chunkHash[mProgChunks]; // Hash of each chunk of 'data'
 	microBlockManager* block[mProgSize/2]; // Array of Block Managers
 	std::deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
 	u32 startPC; // Start PC of this program
@@ -148,6 +151,7 @@ struct microProgram {
 };
 
 typedef std::deque<microProgram*> microProgramList;
+typedef std::unordered_map<u64, microProgram*> microProgramIndex;
 
 struct microProgramQuick {
 	microBlockManager*    block; // Quick reference to valid microBlockManager for current startPC
@@ -158,6 +162,13 @@ struct microProgManager {
 	microIR<mProgSize>	IRinfo;				// IR information
 	microProgramList*	prog [mProgSize/2];	// List of microPrograms indexed by startPC values
 	microProgramQuick	quick[mProgSize/2];	// Quick reference to valid microPrograms for current execution
+	microProgramIndex*	index;				// microPrograms by hash of their data and startPC
+	u64					chunkHash[mProgChunks]; // Hash of each chunk of mVU.regs().Micro
+	u64					dirtyChunks;		// Chunks written since their hash was taken (1 bit per chunk)
+	u32					hashHits;			// Searches resolved by the hash index
+	u32					scanHits;			// Searches resolved by scanning the startPC list
+	u32					misses;				// Searches that had to create a new microProgram
+	u64					bytesCompared;		// Bytes memcmp'd while searching
 	microProgram*		cur;				// Pointer to currently running MicroProgram
 	int					total;				// Total Number of valid MicroPrograms
 	int					isSame;				// Current cached microProgram is Exact Same program as mVU.regs().Micro (-1 = unknown, 0 = No, 1 = Yes)
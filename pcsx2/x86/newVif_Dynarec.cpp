@@ -22,6 +22,7 @@
 #include "MTVU.h"
 
 static void recReset(int idx) {
+	nVif[idx].vifBlocks.report(idx);
 	nVif[idx].vifBlocks.reset();
 
 	nVif[idx].recReserve->Reset();
@@ -44,6 +45,8 @@ void dVifReset(int idx) {
 }
 
 void dVifClose(int idx) {
+	nVif[idx].vifBlocks.report(idx);
+
 	if (nVif[idx].recReserve)
 		nVif[idx].recReserve->Reset();
 }
@@ -17,8 +17,8 @@
 
 #include <array>
 
-// nVifBlock - Ordered for Hashing; the 'num' and 'upkType' fields are
-//             used as the hash bucket selector.
+// nVifBlock - Ordered for Hashing; the first 12 bytes (hash_key, key0 and
+//             key1) form the lookup key of the HashBucket.
 union nVifBlock {
 	// Warning: order depends on the newVifDynaRec code
 	struct {
@@ -43,95 +43,180 @@ union nVifBlock {
 
 }; // 16 bytes
 
-// 0x4000 is enough but 0x10000 allow
-// * to skip the compare value of the first double world in lookup
-// * to use a 16 bits move instead of an 'and' mask to compute the hashed key
-#define hSize 0x10000 // [usn*1:mask*1:upk*4:num*8] hash...
+// Bound on the number of slots visited by a lookup. An insert which can't
+// find a free slot within this distance grows the table instead, so a miss
+// never costs more than kMaxProbe compares.
+static const u32 kMaxProbe = 16;
+
+struct HashBucketStats {
+	u64 hits;					// lookups answered from the table
+	u64 misses;					// lookups which ended up compiling a new block
+	u32 resets;					// times the table (and its code cache) was flushed
+	u32 grows;					// times the table was doubled
+	u32 probes[kMaxProbe];		// blocks by distance from their home slot
+};
 
-// HashBucket is a container which uses a built-in hash function
-// to perform quick searches. It is designed around the nVifBlock structure
+// HashBucket is an open-addressing (linear probing) table of nVifBlocks,
+// keyed by the whole block description (hash_key, key0 and key1). The
+// generated unpackers themselves live in the nVif recompiler reserve, which
+// is filled linearly and flushed together with this table, so each slot only
+// has to hold the 16 byte key and the code pointer.
 //
-// The hash function is determined by taking the first bytes of data and
-// performing a modulus the size of hSize. So the most diverse-data should
-// be in the first bytes of the struct. (hence why nVifBlock is specifically sorted)
+// An empty slot is one with startPtr == 0.
 class HashBucket {
 protected:
-	std::array<nVifBlock*, hSize> m_bucket;
+	nVifBlock*		m_table;
+	u32				m_mask;		// capacity - 1, capacity is a power of two
+	u32				m_count;
+	HashBucketStats	m_stats;
+
+	static __fi u32 hash(const nVifBlock& b) {
+		u32 h = b.hash_key ^ (b.key0 * 0x9E3779B1u) ^ (b.key1 * 0x85EBCA77u);
+		h ^= h >> 15;
+		h *= 0x2C1B3C6Du;
+		h ^= h >> 16;
+		return h;
+	}
 
-public:
-	HashBucket() {
-		m_bucket.fill(nullptr);
+	static __fi bool match(const nVifBlock& a, const nVifBlock& b) {
+		return a.key0 == b.key0 && a.key1 == b.key1 && a.hash_key == b.hash_key;
 	}
 
-	~HashBucket() { clear(); }
+	void alloc(u32 capacity) {
+		const size_t bytes = sizeof(nVifBlock) * capacity;
 
-	__fi nVifBlock* find(const nVifBlock& dataPtr) {
-		nVifBlock* chainpos = m_bucket[dataPtr.hash_key];
+		// Performance note: 64B align to reduce cache miss penalty in `find`
+		if ((m_table = (nVifBlock*)_aligned_malloc(bytes, 64)) == nullptr) {
+			throw Exception::OutOfMemory(
+				wxsFormat(L"HashBucket Table (capacity=%u)", capacity)
+			);
+		}
+
+		memset(m_table, 0, bytes);
+		m_mask  = capacity - 1;
+		m_count = 0;
+	}
+
+	// Returns false when no free slot is within kMaxProbe of the home slot.
+	bool insert(const nVifBlock& dataPtr) {
+		u32 slot = hash(dataPtr);
+
+		for (u32 i = 0; i < kMaxProbe; i++, slot++) {
+			nVifBlock& cell = m_table[slot & m_mask];
+			if (cell.startPtr == 0) {
+				memcpy(&cell, &dataPtr, sizeof(nVifBlock));
+				m_count++;
+				m_stats.probes[i]++;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void grow() {
+		nVifBlock* old = m_table;
+		const u32  oldCapacity = m_mask + 1;
+		u32        capacity    = oldCapacity * 2;
+
+		m_stats.grows++;
+		memset(m_stats.probes, 0, sizeof(m_stats.probes));
 
 		while (true) {
-			if (chainpos->key0 == dataPtr.key0 && chainpos->key1 == dataPtr.key1)
-				return chainpos;
+			alloc(capacity);
 
-			if (chainpos->startPtr == 0)
-				return nullptr;
+			u32 i = 0;
+			for (; i < oldCapacity; i++) {
+				if (old[i].startPtr != 0 && !insert(old[i]))
+					break;
+			}
 
-			chainpos++;
+			if (i == oldCapacity)
+				break;
+
+			// Pathological clustering, try again with more room
+			safe_aligned_free(m_table);
+			memset(m_stats.probes, 0, sizeof(m_stats.probes));
+			capacity *= 2;
 		}
+
+		safe_aligned_free(old);
 	}
 
-	void add(const nVifBlock& dataPtr) {
-		u32 b = dataPtr.hash_key;
+public:
+	static const u32 kInitialCapacity = 0x1000;
+
+	HashBucket()
+		: m_table(nullptr)
+		, m_mask(0)
+		, m_count(0)
+	{
+		memset(&m_stats, 0, sizeof(m_stats));
+	}
 
-		u32 size = bucket_size( dataPtr );
+	~HashBucket() { clear(); }
 
-		// Warning there is an extra +1 due to the empty cell
-		// Performance note: 64B align to reduce cache miss penalty in `find`
-		if( (m_bucket[b] = (nVifBlock*)pcsx2_aligned_realloc( m_bucket[b], sizeof(nVifBlock)*(size+2), 64, sizeof(nVifBlock)*(size+1) )) == NULL ) {
-			throw Exception::OutOfMemory(
-				wxsFormat(L"HashBucket Chain (bucket size=%d)", size+2)
-			);
+	__fi nVifBlock* find(const nVifBlock& dataPtr) {
+		u32 slot = hash(dataPtr);
+
+		for (u32 i = 0; i < kMaxProbe; i++, slot++) {
+			nVifBlock& cell = m_table[slot & m_mask];
+
+			if (cell.startPtr == 0)
+				break;
+
+			if (match(cell, dataPtr)) {
+				m_stats.hits++;
+				return &cell;
+			}
 		}
 
-		// Replace the empty cell by the new block and create a new empty cell
-		memcpy(&m_bucket[b][size++], &dataPtr, sizeof(nVifBlock));
-		memset(&m_bucket[b][size], 0, sizeof(nVifBlock));
+		m_stats.misses++;
+		return nullptr;
+	}
 
-#ifndef NDEBUG
-		if( size > 3 )
-			log_cb(RETRO_LOG_DEBUG, "recVifUnpk: Bucket 0x%04x has %d micro-programs\n", b, size );
-#endif
+	void add(const nVifBlock& dataPtr) {
+		// Keep the load factor at or below 1/2 so probe runs stay short
+		if ((m_count + 1) * 2 > m_mask + 1)
+			grow();
+
+		while (!insert(dataPtr))
+			grow();
 	}
 
-	u32 bucket_size(const nVifBlock& dataPtr) {
-		nVifBlock* chainpos = m_bucket[dataPtr.hash_key];
+	u32 size() const { return m_count; }
+	u32 capacity() const { return m_mask + 1; }
+	const HashBucketStats& stats() const { return m_stats; }
 
-		u32 size = 0;
+	void report(int idx) const {
+		const u64 lookups = m_stats.hits + m_stats.misses;
+		if (lookups == 0)
+			return;
 
-		while (chainpos->startPtr != 0) {
-			size++;
-			chainpos++;
-		}
+		log_cb(RETRO_LOG_DEBUG, "nVif%d: %u blocks in %u slots, %llu lookups, %.2f%% hits, %u resets, %u grows\n",
+			idx, m_count, m_mask + 1, (unsigned long long)lookups,
+			100.0 * (double)m_stats.hits / (double)lookups, m_stats.resets, m_stats.grows);
 
-		return size;
+		for (u32 i = 0; i < kMaxProbe; i++) {
+			if (m_stats.probes[i])
+				log_cb(RETRO_LOG_DEBUG, "nVif%d:   probe %2u: %u blocks\n", idx, i, m_stats.probes[i]);
+		}
 	}
 
 	void clear() {
-		for (auto& bucket : m_bucket)
-			safe_aligned_free(bucket);
+		safe_aligned_free(m_table);
+		m_mask  = 0;
+		m_count = 0;
 	}
 
 	void reset() {
-		clear();
+		const bool wasAllocated = m_table != nullptr;
 
-		// Allocate an empty cell for all buckets
-		for (auto& bucket : m_bucket) {
-			if( (bucket = (nVifBlock*)_aligned_malloc( sizeof(nVifBlock), 64 )) == nullptr ) {
-				throw Exception::OutOfMemory(
-						wxsFormat(L"HashBucket Chain (bucket size=%d)", 1)
-						);
-			}
+		clear();
+		alloc(kInitialCapacity);
 
-			memset(bucket, 0, sizeof(nVifBlock));
-		}
+		if (wasAllocated)
+			m_stats.resets++;
+		memset(m_stats.probes, 0, sizeof(m_stats.probes));
 	}
 };
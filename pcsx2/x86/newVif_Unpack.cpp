@@ -103,13 +103,15 @@ _vifT int nVifUnpack(const u8* data) {
 	const uint ret    = std::min(vif.vifpacketsize, vif.tag.size);
 	const bool isFill = (vifRegs.cycle.cl < wl);
 	s32		   size   = ret << 2;
-	
+	bool	   stable = false;
+
 	if (ret == vif.tag.size) { // Full Transfer
 		if (v.bSize) { // Last transfer was partial
 			memcpy(&v.buffer[v.bSize], data, size);
 			v.bSize		+= size;
 			size        = v.bSize;
 			data		= v.buffer;
+			stable		= true; // Not written again before WaitRefs()
 
 			vif.cl		= 0;
 			vifRegs.num	= (vifXRegs.code >> 16) & 0xff;		// grab NUM form the original VIFcode input.
@@ -120,7 +122,7 @@ _vifT int nVifUnpack(const u8* data) {
 			if (newVifDynaRec)	dVifUnpack<idx>(data, isFill);
 			else			   _nVifUnpack(idx, data, vifRegs.mode, isFill);
 		}
-		else vu1Thread.VifUnpack(vif, vifRegs, (u8*)data, (size + 4) & ~0x3);
+		else vu1Thread.VifUnpack(vif, vifRegs, (u8*)data, (size + 4) & ~0x3, stable);
 
 		vif.pass		= 0;
 		vif.tag.size	= 0;
@@ -129,6 +131,8 @@ _vifT int nVifUnpack(const u8* data) {
 		v.bSize			= 0;
 	}
 	else { // Partial Transfer
+		// The MTVU thread may still be unpacking the last reassembled transfer
+		if (idx && THREAD_VU1 && !v.bSize) vu1Thread.WaitRefs();
 		memcpy(&v.buffer[v.bSize], data, size);
 		v.bSize		 += size;
 		vif.tag.size -= ret;
@@ -23,6 +23,7 @@
 #include "GS.h"
 #include "GSUtil.h"
 #include "Renderers/SW/GSRendererSW.h"
+#include "Renderers/SW/GSDeviceSW.h"
 #include "Renderers/Null/GSRendererNull.h"
 #include "Renderers/Null/GSDeviceNull.h"
 #include "Renderers/OpenGL/GSDeviceOGL.h"
@@ -110,6 +111,8 @@ EXPORT_C GSshutdown()
 	delete s_gs;
 	s_gs = nullptr;
 
+	GSCodeGeneratorKeyCache::Shutdown();
+
 	theApp.SetCurrentRendererType(GSRendererType::Undefined);
 }
 
@@ -192,6 +195,10 @@ static int _GSopen(const char* title, GSRendererType renderer, int threads = -1)
 			dev = new GSDeviceOGL();
 			renderer_name = "Software";
 			break;
+		case GSRendererType::SW:
+			dev = new GSDeviceSW();
+			renderer_name = "Software (CPU)";
+			break;
 		case GSRendererType::Null:
 			dev = new GSDeviceNull();
 			renderer_name = "Null";
@@ -220,6 +227,7 @@ static int _GSopen(const char* title, GSRendererType renderer, int threads = -1)
 				s_gs = (GSRenderer*)new GSRendererOGL();
 				break;
 			case GSRendererType::OGL_SW:
+			case GSRendererType::SW:
 				s_gs = new GSRendererSW(threads);
 				break;
 			case GSRendererType::Null:
@@ -241,6 +249,26 @@ static int _GSopen(const char* title, GSRendererType renderer, int threads = -1)
 	return 0;
 }
 
+// Opens a renderer on a null device, without a frontend or window (used by GSReplay).
+int GSopenHeadless(GSRenderer* renderer)
+{
+	delete s_gs;
+
+	s_gs = renderer;
+
+	theApp.SetCurrentRendererType(GSRendererType::Null);
+
+	s_gs->SetRegsMem(s_basemem);
+
+	if(!s_gs->CreateDevice(new GSDeviceNull()))
+	{
+		GSclose();
+		return -1;
+	}
+
+	return 0;
+}
+
 void GSUpdateOptions()
 {
 	s_gs->UpdateRendererOptions();
@@ -259,8 +287,16 @@ EXPORT_C_(int) GSopen2(uint32 flags)
 			log_cb(RETRO_LOG_INFO, "Selected Renderer: DX1011_HW\n" );
 			break;
 		case RETRO_HW_CONTEXT_NONE:
-			theApp.SetCurrentRendererType(GSRendererType::Null);
-			log_cb(RETRO_LOG_INFO, "Selected Renderer: NULL\n");
+			if (! std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "CPU"))
+			{
+				theApp.SetCurrentRendererType(GSRendererType::SW);
+				log_cb(RETRO_LOG_INFO, "Selected Renderer: SW\n");
+			}
+			else
+			{
+				theApp.SetCurrentRendererType(GSRendererType::Null);
+				log_cb(RETRO_LOG_INFO, "Selected Renderer: NULL\n");
+			}
 			break;
 		default:
 			if (! std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software"))
@@ -294,6 +330,9 @@ EXPORT_C_(int) GSopen2(uint32 flags)
 			case GSRendererType::OGL_HW:
 				current_renderer = GSRendererType::OGL_SW;
 				break;
+			case GSRendererType::SW:
+				// No hw context to switch to
+				break;
 			default:
 				current_renderer = GSRendererType::OGL_SW;
 				break;
@@ -381,9 +420,30 @@ EXPORT_C_(int) GSfreeze(int mode, GSFreezeData* data)
 	return 0;
 }
 
+EXPORT_C_(int) GSdumpBegin(const char* filename)
+{
+	if(s_gs == NULL)
+		return -1;
+
+	return s_gs->BeginDump(filename) ? 0 : -1;
+}
+
+EXPORT_C GSdumpEnd()
+{
+	if(s_gs)
+		s_gs->EndDump();
+}
+
 EXPORT_C GSsetGameCRC(uint32 crc, int options)
 {
 	s_gs->SetGameCRC(crc, options);
+
+	GSCodeGeneratorKeyCache::SetGame(crc);
+}
+
+EXPORT_C GSsetCacheDir(const char* dir)
+{
+	GSCodeGeneratorKeyCache::SetDirectory(dir ? dir : "");
 }
 
 EXPORT_C GSsetFrameSkip(int frameskip)
@@ -624,6 +684,7 @@ void GSdxApp::Init()
 	m_current_configuration["dithering_ps2"]                              = "2";
 	m_current_configuration["dump"]                                       = "0";
 	m_current_configuration["extrathreads"]                               = "2";
+	m_current_configuration["extrathreads_binning"]                       = "0";
 	m_current_configuration["extrathreads_height"]                        = "4";
 	m_current_configuration["filter"]                                     = std::to_string(static_cast<int8>(BiFiltering::PS2));
 	m_current_configuration["force_texture_clear"]                        = "0";
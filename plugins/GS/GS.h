@@ -230,6 +230,7 @@ enum class GSRendererType : int8_t
 	Null = 11,
 	OGL_HW,
 	OGL_SW,
+	SW,
 
 #ifdef _WIN32
 	Default = Undefined
@@ -1355,4 +1356,7 @@ struct GSDXErrorGlVertexArrayTooSmall : GSDXError {};
 
 GSVector4i GSClientRect(void);
 
+class GSRenderer;
+int GSopenHeadless(GSRenderer* renderer);
+
 extern GSdxApp theApp;
@@ -0,0 +1,197 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "GSDump.h"
+#include "options_tools.h"
+
+static const char s_magic[8] = {'G', 'S', 'D', 'U', 'M', 'P', '0', '1'};
+
+GSDumpWriter::GSDumpWriter(const std::string& fn, uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs)
+	: m_frames(0)
+{
+	m_fp = fopen(fn.c_str(), "wb");
+
+	if(!m_fp)
+		return;
+
+	memcpy(&m_regs, regs, sizeof(m_regs));
+
+	Write(s_magic, sizeof(s_magic));
+	Write(&crc, sizeof(crc));
+	Write(&fd.size, sizeof(fd.size));
+	Write(fd.data, fd.size);
+	Write(&m_regs, sizeof(m_regs));
+}
+
+GSDumpWriter::~GSDumpWriter()
+{
+	if(m_fp)
+		fclose(m_fp);
+}
+
+void GSDumpWriter::Write(const void* data, size_t size)
+{
+	if(m_fp && size > 0 && fwrite(data, size, 1, m_fp) != 1)
+	{
+		log_cb(RETRO_LOG_ERROR, "GS dump: write failed, recording stopped\n");
+
+		fclose(m_fp);
+
+		m_fp = NULL;
+	}
+}
+
+void GSDumpWriter::Transfer(int index, const uint8* mem, size_t size)
+{
+	uint8 type = GSDUMP_TRANSFER;
+	uint8 path = (uint8)index;
+	uint32 bytes = (uint32)size;
+
+	Write(&type, sizeof(type));
+	Write(&path, sizeof(path));
+	Write(&bytes, sizeof(bytes));
+	Write(mem, size);
+}
+
+void GSDumpWriter::ReadFIFO(uint32 size)
+{
+	uint8 type = GSDUMP_READFIFO;
+
+	Write(&type, sizeof(type));
+	Write(&size, sizeof(size));
+}
+
+void GSDumpWriter::SoftReset(uint32 mask)
+{
+	uint8 type = GSDUMP_SOFTRESET;
+
+	Write(&type, sizeof(type));
+	Write(&mask, sizeof(mask));
+}
+
+void GSDumpWriter::VSync(int field, const GSPrivRegSet* regs)
+{
+	if(memcmp(&m_regs, regs, sizeof(m_regs)) != 0)
+	{
+		uint8 type = GSDUMP_REGISTERS;
+
+		memcpy(&m_regs, regs, sizeof(m_regs));
+
+		Write(&type, sizeof(type));
+		Write(&m_regs, sizeof(m_regs));
+	}
+
+	uint8 type = GSDUMP_VSYNC;
+	uint8 f = (uint8)field;
+
+	Write(&type, sizeof(type));
+	Write(&f, sizeof(f));
+
+	m_frames++;
+}
+
+//
+
+bool GSDumpReader::Load(const std::string& fn)
+{
+	FILE* fp = fopen(fn.c_str(), "rb");
+
+	if(!fp)
+		return false;
+
+	bool ok = false;
+
+	char magic[8];
+	uint32 state_size = 0;
+
+	if(fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, s_magic, sizeof(magic)) == 0
+	&& fread(&m_crc, sizeof(m_crc), 1, fp) == 1
+	&& fread(&state_size, sizeof(state_size), 1, fp) == 1)
+	{
+		m_state.resize(state_size);
+
+		ok = fread(m_state.data(), state_size, 1, fp) == 1
+		  && fread(&m_regs, sizeof(m_regs), 1, fp) == 1;
+	}
+
+	const bool header = ok;
+
+	m_packets.clear();
+
+	uint8 type;
+
+	while(ok && fread(&type, sizeof(type), 1, fp) == 1)
+	{
+		Packet p;
+
+		p.type = (GSDumpPacketType)type;
+		p.param = 0;
+
+		switch(type)
+		{
+		case GSDUMP_TRANSFER:
+			{
+				uint8 path = 0;
+
+				ok = fread(&path, sizeof(path), 1, fp) == 1
+				  && fread(&p.param, sizeof(p.param), 1, fp) == 1;
+
+				if(ok)
+				{
+					p.data.resize(p.param);
+					p.param = path;
+
+					ok = p.data.empty() || fread(p.data.data(), p.data.size(), 1, fp) == 1;
+				}
+			}
+			break;
+		case GSDUMP_VSYNC:
+			{
+				uint8 field = 0;
+
+				ok = fread(&field, sizeof(field), 1, fp) == 1;
+
+				p.param = field;
+			}
+			break;
+		case GSDUMP_READFIFO:
+		case GSDUMP_SOFTRESET:
+			ok = fread(&p.param, sizeof(p.param), 1, fp) == 1;
+			break;
+		case GSDUMP_REGISTERS:
+			p.data.resize(sizeof(GSPrivRegSet));
+			ok = fread(p.data.data(), p.data.size(), 1, fp) == 1;
+			break;
+		default:
+			ok = false;
+			break;
+		}
+
+		if(ok)
+			m_packets.push_back(std::move(p));
+	}
+
+	fclose(fp);
+
+	// A recording that was cut short only loses its last, incomplete packet.
+	return header;
+}
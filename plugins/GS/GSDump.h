@@ -0,0 +1,98 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "GS.h"
+#include <vector>
+
+/*
+
+GS dump file layout (all values little endian):
+
+header:
+	char[8]   magic "GSDUMP01"
+	uint32    game crc
+	uint32    state size
+	uint8[]   state (GSfreeze)
+	GSPrivRegSet
+
+packets, until the end of the file:
+	uint8     type
+	TRANSFER  uint8 path (0-3), uint32 size (bytes), uint8[size] data
+	VSYNC     uint8 field
+	READFIFO  uint32 size (qwords)
+	REGISTERS GSPrivRegSet (only written when the registers changed)
+	SOFTRESET uint32 mask
+
+The privileged registers are written directly into memory by the emulator, so they are
+only sampled at vsync, which is when the renderer reads most of them.
+
+*/
+
+enum GSDumpPacketType : uint8
+{
+	GSDUMP_TRANSFER,
+	GSDUMP_VSYNC,
+	GSDUMP_READFIFO,
+	GSDUMP_REGISTERS,
+	GSDUMP_SOFTRESET,
+};
+
+class GSDumpWriter
+{
+	FILE* m_fp;
+	GSPrivRegSet m_regs;
+	int m_frames;
+
+	void Write(const void* data, size_t size);
+
+public:
+	GSDumpWriter(const std::string& fn, uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs);
+	virtual ~GSDumpWriter();
+
+	bool IsOpen() const {return m_fp != NULL;}
+	int GetFrames() const {return m_frames;}
+
+	void Transfer(int index, const uint8* mem, size_t size);
+	void ReadFIFO(uint32 size);
+	void SoftReset(uint32 mask);
+	void VSync(int field, const GSPrivRegSet* regs);
+};
+
+class GSDumpReader
+{
+public:
+	struct Packet
+	{
+		GSDumpPacketType type;
+		uint32 param; // path, field, size or mask
+		std::vector<uint8> data;
+	};
+
+	uint32 m_crc;
+	std::vector<uint8> m_state;
+	GSPrivRegSet m_regs;
+	std::vector<Packet> m_packets;
+
+	// Reads the whole dump into memory, so that replaying it doesn't touch the disk.
+	bool Load(const std::string& fn);
+};
@@ -90,6 +90,7 @@ GSLocalMemory::GSLocalMemory()
 	m_use_fifo_alloc = theApp.GetConfigB("UserHacks") && theApp.GetConfigB("wrap_gs_mem");
 	switch (theApp.GetCurrentRendererType()) {
 		case GSRendererType::OGL_SW:
+		case GSRendererType::SW:
 			m_use_fifo_alloc = true;
 			break;
 		default:
@@ -0,0 +1,321 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// GSReplay: replays a GS dump (see GSDump.h) as fast as possible on the software or null
+// renderer, without the emulator core, a frontend or a window, and reports the frame rate
+// and the time spent per draw.  Output goes to a null device, so only emulation and
+// rasterization are measured.
+
+#include "stdafx.h"
+#include "GS.h"
+#include "GSDump.h"
+#include "Renderers/SW/GSRendererSW.h"
+#include "Renderers/Null/GSRendererNull.h"
+
+#include <chrono>
+
+// The plugin normally gets these from the libretro core.
+
+retro_hw_render_callback hw_render;
+retro_environment_t environ_cb;
+retro_video_refresh_t video_cb;
+retro_log_printf_t log_cb;
+int option_upscale_mult = 1;
+
+static void replay_log(enum retro_log_level level, const char* fmt, ...)
+{
+	if(level < RETRO_LOG_WARN)
+		return;
+
+	va_list args;
+
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+static bool replay_environment(unsigned cmd, void* data)
+{
+	return false;
+}
+
+EXPORT_C GSgifTransfer(const uint8* mem, uint32 size);
+EXPORT_C GSgifTransfer1(uint8* mem, uint32 addr);
+EXPORT_C GSgifTransfer2(uint8* mem, uint32 size);
+EXPORT_C GSgifTransfer3(uint8* mem, uint32 size);
+EXPORT_C GSgifSoftReset(uint32 mask);
+EXPORT_C GSreadFIFO2(uint8* mem, uint32 size);
+EXPORT_C GSvsync(int field);
+EXPORT_C GSsetBaseMem(uint8* mem);
+EXPORT_C GSsetGameCRC(uint32 crc, int options);
+EXPORT_C GSsetCacheDir(const char* dir);
+EXPORT_C_(int) GSfreeze(int mode, GSFreezeData* data);
+EXPORT_C_(int) GSinit();
+EXPORT_C GSshutdown();
+
+typedef std::chrono::steady_clock replay_clock;
+
+// Times every draw of the wrapped renderer.  With extra threads the software renderer only
+// queues the draw, so the time is setup only and the rasterization shows up in the fps.
+template<class T> class GSTimedRenderer : public T
+{
+public:
+	uint64 m_draws;
+	uint64 m_draw_ns;
+	uint64 m_draw_max_ns;
+
+	template<class... Args> GSTimedRenderer(Args... args)
+		: T(args...)
+	{
+		ResetStats();
+	}
+
+	void ResetStats()
+	{
+		m_draws = 0;
+		m_draw_ns = 0;
+		m_draw_max_ns = 0;
+	}
+
+protected:
+	void Draw()
+	{
+		replay_clock::time_point start = replay_clock::now();
+
+		T::Draw();
+
+		uint64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(replay_clock::now() - start).count();
+
+		m_draws++;
+		m_draw_ns += ns;
+		m_draw_max_ns = std::max(m_draw_max_ns, ns);
+	}
+};
+
+// Output is never presented, so renderer changes are checked by comparing the GS state,
+// which includes the local memory, after the replay.
+static uint64 state_checksum()
+{
+	GSFreezeData fd = {0, NULL};
+
+	GSfreeze(FREEZE_SIZE, &fd);
+
+	std::vector<uint8> state(fd.size);
+
+	fd.data = state.data();
+
+	if(GSfreeze(FREEZE_SAVE, &fd) != 0)
+		return 0;
+
+	uint64 hash = 0xcbf29ce484222325ull; // FNV-1a
+
+	for(uint8 b : state)
+	{
+		hash = (hash ^ b) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: GSReplay [options] dump.gs\n"
+		"  -r sw|null   renderer (default sw)\n"
+		"  -t n         extra rasterizer threads for sw (default 0, draw timings are exact)\n"
+		"  -b           let the sw threads draw binned primitives instead of scanline bands\n"
+		"  -l n         number of times to replay the dump (default 1)\n"
+		"  -j dir       keep the game's JIT function keys in dir and prepare them at startup\n");
+}
+
+int main(int argc, char** argv)
+{
+	std::string renderer = "sw";
+	std::string fn;
+	std::string jit_dir;
+	int threads = 0;
+	int loops = 1;
+	bool binning = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if(arg == "-r" && i + 1 < argc) renderer = argv[++i];
+		else if(arg == "-t" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if(arg == "-b") binning = true;
+		else if(arg == "-j" && i + 1 < argc) jit_dir = argv[++i];
+		else if(arg == "-l" && i + 1 < argc) loops = std::max(atoi(argv[++i]), 1);
+		else if(arg[0] != '-' && fn.empty()) fn = arg;
+		else {usage(); return 1;}
+	}
+
+	if(fn.empty() || (renderer != "sw" && renderer != "null"))
+	{
+		usage();
+		return 1;
+	}
+
+	log_cb = replay_log;
+	environ_cb = replay_environment;
+
+	GSDumpReader dump;
+
+	if(!dump.Load(fn))
+	{
+		fprintf(stderr, "%s: not a GS dump\n", fn.c_str());
+		return 1;
+	}
+
+	if(GSinit() != 0)
+	{
+		fprintf(stderr, "GSinit failed\n");
+		return 1;
+	}
+
+	GSPrivRegSet* regs = (GSPrivRegSet*)_aligned_malloc(sizeof(GSPrivRegSet), 32);
+	uint32 path1_size = 0x4000;
+	uint8* path1 = (uint8*)_aligned_malloc(path1_size, 32);
+	memset(path1, 0, path1_size);
+	std::vector<uint8> fifo;
+
+	GSsetBaseMem((uint8*)regs);
+
+	theApp.SetConfig("extrathreads_binning", binning ? 1 : 0);
+
+	GSsetCacheDir(jit_dir.c_str());
+
+	GSTimedRenderer<GSRendererSW>* sw = NULL;
+	GSTimedRenderer<GSRendererNull>* null = NULL;
+	GSRenderer* gs;
+
+	if(renderer == "sw")
+		gs = sw = new GSTimedRenderer<GSRendererSW>(threads);
+	else
+		gs = null = new GSTimedRenderer<GSRendererNull>();
+
+	if(GSopenHeadless(gs) != 0)
+	{
+		fprintf(stderr, "could not open the %s renderer\n", renderer.c_str());
+		return 1;
+	}
+
+	GSsetGameCRC(dump.m_crc, 0);
+
+	printf("%s: crc %08x, %zu packets, %s renderer, %d extra threads%s\n",
+		fn.c_str(), dump.m_crc, dump.m_packets.size(), renderer.c_str(), threads, binning ? " (binned)" : "");
+
+	for(int loop = 0; loop < loops; loop++)
+	{
+		memcpy(regs, &dump.m_regs, sizeof(GSPrivRegSet));
+
+		std::vector<uint8> state(dump.m_state);
+		GSFreezeData fd = {(int)state.size(), state.data()};
+
+		if(GSfreeze(FREEZE_LOAD, &fd) != 0)
+		{
+			fprintf(stderr, "the dump's GS state could not be loaded\n");
+			return 1;
+		}
+
+		if(sw) sw->ResetStats();
+		if(null) null->ResetStats();
+
+		int frames = 0;
+
+		replay_clock::time_point start = replay_clock::now();
+
+		for(const GSDumpReader::Packet& p : dump.m_packets)
+		{
+			switch(p.type)
+			{
+			case GSDUMP_TRANSFER:
+				switch(p.param)
+				{
+				case 0:
+					{
+						// PATH1 reads from VU1 memory up to its end, and wraps back 16KB when
+						// the packet isn't finished there; put the data at the end of a buffer
+						// of at least that size.  Packets larger than VU1 memory grow the
+						// buffer rather than being cut short.
+						uint32 size = p.data.size() & ~15;
+
+						if(size > path1_size)
+						{
+							_aligned_free(path1);
+							path1_size = size;
+							path1 = (uint8*)_aligned_malloc(path1_size, 32);
+							memset(path1, 0, path1_size);
+						}
+
+						uint8* mem = path1 + path1_size - size;
+						memcpy(mem, p.data.data(), size);
+						gs->Transfer<0>(mem, size / 16);
+					}
+					break;
+				case 1:
+					GSgifTransfer2(const_cast<uint8*>(p.data.data()), p.data.size() / 16);
+					break;
+				case 2:
+					GSgifTransfer3(const_cast<uint8*>(p.data.data()), p.data.size() / 16);
+					break;
+				case 3:
+					GSgifTransfer(p.data.data(), p.data.size() / 16);
+					break;
+				}
+				break;
+			case GSDUMP_VSYNC:
+				GSvsync(p.param);
+				frames++;
+				break;
+			case GSDUMP_READFIFO:
+				fifo.resize(p.param * 16);
+				GSreadFIFO2(fifo.data(), p.param);
+				break;
+			case GSDUMP_REGISTERS:
+				memcpy(regs, p.data.data(), sizeof(GSPrivRegSet));
+				break;
+			case GSDUMP_SOFTRESET:
+				GSgifSoftReset(p.param);
+				break;
+			}
+		}
+
+		double seconds = std::chrono::duration<double>(replay_clock::now() - start).count();
+
+		uint64 draws = sw ? sw->m_draws : null->m_draws;
+		uint64 draw_ns = sw ? sw->m_draw_ns : null->m_draw_ns;
+		uint64 draw_max_ns = sw ? sw->m_draw_max_ns : null->m_draw_max_ns;
+
+		printf("loop %d: %d frames in %.3f s, %.2f fps, %llu draws (%.1f per frame), %.2f us per draw, %.2f us max, state %016llx\n",
+			loop + 1, frames, seconds, seconds > 0 ? frames / seconds : 0.0,
+			(unsigned long long)draws, frames ? (double)draws / frames : 0.0,
+			draws ? draw_ns / 1000.0 / draws : 0.0, draw_max_ns / 1000.0,
+			(unsigned long long)state_checksum());
+	}
+
+	GSshutdown();
+
+	_aligned_free(path1);
+	_aligned_free(regs);
+
+	return 0;
+}
@@ -163,6 +163,49 @@ void GSState::SetRegsMem(uint8* basemem)
 	m_regs = (GSPrivRegSet*)basemem;
 }
 
+bool GSState::BeginDump(const std::string& fn)
+{
+	EndDump();
+
+	GSFreezeData fd = {0, NULL};
+
+	Freeze(&fd, true);
+
+	std::vector<uint8> state(fd.size);
+
+	fd.data = state.data();
+
+	if(Freeze(&fd, false) != 0)
+	{
+		return false;
+	}
+
+	m_dump.reset(new GSDumpWriter(fn, m_crc, fd, m_regs));
+
+	if(!m_dump->IsOpen())
+	{
+		log_cb(RETRO_LOG_ERROR, "GS dump: could not create %s\n", fn.c_str());
+
+		m_dump.reset();
+
+		return false;
+	}
+
+	log_cb(RETRO_LOG_INFO, "GS dump: recording to %s\n", fn.c_str());
+
+	return true;
+}
+
+void GSState::EndDump()
+{
+	if(!m_dump)
+		return;
+
+	log_cb(RETRO_LOG_INFO, "GS dump: recorded %d frames\n", m_dump->GetFrames());
+
+	m_dump.reset();
+}
+
 void GSState::SetMultithreaded(bool mt)
 {
 	// Some older versions of PCSX2 didn't properly set the irq callback to NULL
@@ -1981,6 +2024,9 @@ void GSState::Move()
 
 void GSState::SoftReset(uint32 mask)
 {
+	if(m_dump)
+		m_dump->SoftReset(mask);
+
 	if(mask & 1)
 	{
 		memset(&m_path[0], 0, sizeof(GIFPath));
@@ -1997,6 +2043,9 @@ void GSState::SoftReset(uint32 mask)
 
 void GSState::ReadFIFO(uint8* mem, int size)
 {
+	if(m_dump)
+		m_dump->ReadFIFO(size);
+
 	Flush();
 
 	size *= 16;
@@ -2215,6 +2264,11 @@ template<int index> void GSState::Transfer(const uint8* mem, uint32 size)
 		}
 	}
 
+	if(m_dump && mem > start)
+	{
+		m_dump->Transfer(index, start, mem - start);
+	}
+
 	if(index == 0)
 	{
 		if(size == 0 && path.nloop > 0)
@@ -2334,6 +2388,9 @@ int GSState::Freeze(GSFreezeData* fd, bool sizeonly)
 
 int GSState::Defrost(const GSFreezeData* fd)
 {
+	// The recording can't follow a jump to another state.
+	EndDump();
+
 	if(!fd || !fd->data || fd->size == 0)
 	{
 		return -1;
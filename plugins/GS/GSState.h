@@ -32,6 +32,7 @@
 #include "Renderers/Common/GSDevice.h"
 #include "GSCrc.h"
 #include "GSAlignedClass.h"
+#include "GSDump.h"
 
 struct GSFrameInfo
 {
@@ -222,6 +223,8 @@ public:
 	bool m_nativeres;
 	int m_mipmap;
 
+	std::unique_ptr<GSDumpWriter> m_dump;
+
 	static int s_n;
 	bool s_save;
 	bool s_savet;
@@ -272,5 +275,8 @@ public:
 	void SetRegsMem(uint8* basemem);
 	void SetIrqCallback(void (*irq)());
 	void SetMultithreaded(bool mt = true);
+
+	bool BeginDump(const std::string& fn);
+	void EndDump();
 };
 
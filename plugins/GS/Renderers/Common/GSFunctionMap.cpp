@@ -0,0 +1,246 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "GSFunctionMap.h"
+#include "options_tools.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <set>
+#include <thread>
+
+// The key files are plain text, one "<generator name> <key>" line per function.
+
+static std::mutex s_lock;
+static std::condition_variable s_idle;
+static std::string s_dir;
+static uint32 s_crc = 0;
+static std::map<std::string, std::set<uint64>> s_keys;
+static bool s_dirty = false;
+static std::vector<GSCodeGeneratorKeyCache::Client*> s_clients;
+static std::deque<std::pair<GSCodeGeneratorKeyCache::Client*, uint64>> s_pending;
+static GSCodeGeneratorKeyCache::Client* s_busy = NULL;
+static bool s_running = false;
+static struct {int hits, misses;} s_stats = {0, 0};
+
+static std::string KeyFileName(uint32 crc)
+{
+	return format("%s/jit_%08X.txt", s_dir.c_str(), crc);
+}
+
+static void Save()
+{
+	if(s_dirty && !s_dir.empty() && s_crc != 0)
+	{
+		FILE* fp = fopen(KeyFileName(s_crc).c_str(), "w");
+
+		if(fp)
+		{
+			for(auto& i : s_keys)
+			{
+				for(uint64 key : i.second)
+				{
+					fprintf(fp, "%s %016llx\n", i.first.c_str(), (unsigned long long)key);
+				}
+			}
+
+			fclose(fp);
+		}
+		else
+		{
+			log_cb(RETRO_LOG_WARN, "GS: could not write %s\n", KeyFileName(s_crc).c_str());
+		}
+	}
+
+	if(s_crc != 0 && s_stats.hits + s_stats.misses > 0)
+	{
+		log_cb(RETRO_LOG_INFO, "GS: JIT functions for %08X: %d prepared ahead, %d generated on draw\n", s_crc, s_stats.hits, s_stats.misses);
+	}
+
+	s_dirty = false;
+	s_stats.hits = 0;
+	s_stats.misses = 0;
+}
+
+static void Load()
+{
+	s_keys.clear();
+
+	if(s_dir.empty() || s_crc == 0)
+		return;
+
+	FILE* fp = fopen(KeyFileName(s_crc).c_str(), "r");
+
+	if(!fp)
+		return;
+
+	char name[64];
+	unsigned long long key;
+	int count = 0;
+
+	while(fscanf(fp, "%63s %llx", name, &key) == 2)
+	{
+		s_keys[name].insert(key);
+
+		count++;
+	}
+
+	fclose(fp);
+
+	log_cb(RETRO_LOG_INFO, "GS: %d JIT functions to prepare for %08X\n", count, s_crc);
+}
+
+static void ThreadProc()
+{
+	std::unique_lock<std::mutex> l(s_lock);
+
+	while(!s_pending.empty())
+	{
+		auto job = s_pending.front();
+
+		s_pending.pop_front();
+
+		s_busy = job.first;
+
+		l.unlock();
+
+		job.first->Prepare(job.second);
+
+		l.lock();
+
+		s_busy = NULL;
+
+		s_idle.notify_all();
+	}
+
+	s_running = false;
+
+	s_idle.notify_all();
+}
+
+// Must be called with s_lock held.
+static void Enqueue(GSCodeGeneratorKeyCache::Client* c)
+{
+	auto i = s_keys.find(c->GetName());
+
+	if(i == s_keys.end())
+		return;
+
+	for(uint64 key : i->second)
+	{
+		s_pending.push_back(std::make_pair(c, key));
+	}
+
+	if(!s_running && !s_pending.empty())
+	{
+		s_running = true;
+
+		std::thread(ThreadProc).detach();
+	}
+}
+
+void GSCodeGeneratorKeyCache::SetDirectory(const std::string& dir)
+{
+	std::lock_guard<std::mutex> l(s_lock);
+
+	s_dir = dir;
+}
+
+void GSCodeGeneratorKeyCache::SetGame(uint32 crc)
+{
+	std::lock_guard<std::mutex> l(s_lock);
+
+	if(crc == s_crc)
+		return;
+
+	Save();
+
+	s_crc = crc;
+	s_pending.clear();
+
+	Load();
+
+	for(Client* c : s_clients)
+	{
+		Enqueue(c);
+	}
+}
+
+void GSCodeGeneratorKeyCache::Shutdown()
+{
+	std::unique_lock<std::mutex> l(s_lock);
+
+	Save();
+
+	s_crc = 0;
+	s_keys.clear();
+	s_pending.clear();
+
+	while(s_running)
+	{
+		s_idle.wait(l);
+	}
+}
+
+void GSCodeGeneratorKeyCache::Register(Client* c)
+{
+	std::lock_guard<std::mutex> l(s_lock);
+
+	s_clients.push_back(c);
+
+	Enqueue(c);
+}
+
+void GSCodeGeneratorKeyCache::Unregister(Client* c)
+{
+	std::unique_lock<std::mutex> l(s_lock);
+
+	s_clients.erase(std::remove(s_clients.begin(), s_clients.end(), c), s_clients.end());
+
+	s_pending.erase(std::remove_if(s_pending.begin(), s_pending.end(),
+		[c](const std::pair<Client*, uint64>& job) {return job.first == c;}), s_pending.end());
+
+	while(s_busy == c)
+	{
+		s_idle.wait(l);
+	}
+}
+
+void GSCodeGeneratorKeyCache::Hit()
+{
+	std::lock_guard<std::mutex> l(s_lock);
+
+	s_stats.hits++;
+}
+
+void GSCodeGeneratorKeyCache::Miss(const char* name, uint64 key)
+{
+	std::lock_guard<std::mutex> l(s_lock);
+
+	s_stats.misses++;
+
+	if(s_keys[name].insert(key).second)
+	{
+		s_dirty = true;
+	}
+}
@@ -28,6 +28,8 @@
 
 #include "../SW/GSScanlineEnvironment.h"
 
+#include <mutex>
+
 template<class KEY, class VALUE> class GSFunctionMap
 {
 protected:
@@ -83,6 +85,33 @@ public:
 	}
 };
 
+// Remembers the keys the code generators were asked for during a game and stores them per game
+// crc, so that the next session can generate the functions on a background thread before the
+// first draw needs them.  Disabled until a directory is set.
+
+class GSCodeGeneratorKeyCache
+{
+public:
+	class Client
+	{
+	public:
+		virtual ~Client() {}
+
+		virtual const char* GetName() const = 0;
+		virtual void Prepare(uint64 key) = 0;
+	};
+
+	static void SetDirectory(const std::string& dir);
+	static void SetGame(uint32 crc);
+	static void Shutdown();
+
+	static void Register(Client* c);
+	static void Unregister(Client* c);
+
+	static void Hit();
+	static void Miss(const char* name, uint64 key);
+};
+
 class GSCodeGenerator : public Xbyak::CodeGenerator
 {
 protected:
@@ -96,35 +125,78 @@ public:
 };
 
 template<class CG, class KEY, class VALUE>
-class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>
+class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>, public GSCodeGeneratorKeyCache::Client
 {
+	const char* m_name;
 	void* m_param;
 	std::unordered_map<uint64, VALUE> m_cgmap;
 	GSCodeBuffer m_cb;
+	std::mutex m_lock; // the key cache prepares functions from its own thread
+
+	VALUE Generate(KEY key)
+	{
+		CG* cg = new CG(m_param, key, 
+				m_cb.GetBuffer(8192), 8192);
+
+		m_cb.ReleaseBuffer(cg->getSize());
+
+		VALUE ret = m_cgmap[key] = (VALUE)cg->getCode();
+
+		delete cg;
+
+		return ret;
+	}
 
 public:
 	GSCodeGeneratorFunctionMap(const char* name, void* param)
-		: m_param(param) { }
-	~GSCodeGeneratorFunctionMap() { }
+		: m_name(name)
+		, m_param(param)
+	{
+		GSCodeGeneratorKeyCache::Register(this);
+	}
 
-	VALUE GetDefaultFunction(KEY key)
+	~GSCodeGeneratorFunctionMap()
 	{
-		VALUE ret = NULL;
+		GSCodeGeneratorKeyCache::Unregister(this);
+	}
 
-		auto i = m_cgmap.find(key);
+	VALUE GetDefaultFunction(KEY key)
+	{
+		VALUE ret;
+		bool prepared;
 
-		if(i != m_cgmap.end())
-			return i->second;
+		{
+			std::lock_guard<std::mutex> l(m_lock);
 
-		CG* cg = new CG(m_param, key, 
-				m_cb.GetBuffer(8192), 8192);
+			auto i = m_cgmap.find(key);
 
-		m_cb.ReleaseBuffer(cg->getSize());
+			prepared = i != m_cgmap.end();
 
-		ret = m_cgmap[key] = (VALUE)cg->getCode();
+			ret = prepared ? i->second : Generate(key);
+		}
 
-		delete cg;
+		if(prepared)
+			GSCodeGeneratorKeyCache::Hit();
+		else
+			GSCodeGeneratorKeyCache::Miss(m_name, key);
 
 		return ret;
 	}
+
+	// GSCodeGeneratorKeyCache::Client
+
+	const char* GetName() const
+	{
+		return m_name;
+	}
+
+	void Prepare(uint64 key)
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		if(m_cgmap.find(key) == m_cgmap.end())
+		{
+			Generate((KEY)key);
+		}
+	}
 };
@@ -275,6 +275,9 @@ GSVector2i GSRenderer::GetInternalResolution()
 
 void GSRenderer::VSync(int field)
 {
+	if(m_dump)
+		m_dump->VSync(field, m_regs);
+
 	Flush();
 
 	if(!Merge(field ? 1 : 0))
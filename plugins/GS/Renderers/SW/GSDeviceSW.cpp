@@ -0,0 +1,396 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "../../stdafx.h"
+#include "GSDeviceSW.h"
+
+#include <vector>
+#include <libretro.h>
+
+extern retro_video_refresh_t video_cb;
+
+bool GSDeviceSW::Create()
+{
+	if(!GSDevice::Create())
+		return false;
+
+	Reset(1, 1);
+
+	return true;
+}
+
+bool GSDeviceSW::Reset(int w, int h)
+{
+	if(!GSDevice::Reset(w, h))
+		return false;
+
+	m_backbuffer = new GSTextureSW(GSTexture::RenderTarget, w, h);
+
+	return true;
+}
+
+GSTexture* GSDeviceSW::CreateSurface(int type, int w, int h, int format)
+{
+	return new GSTextureSW(type, w, h);
+}
+
+void GSDeviceSW::Present(GSTexture* sTex, GSTexture* dTex, const GSVector4& dRect, int shader)
+{
+	// The post-processing shaders have no cpu version, the frame is only converted to XRGB8888
+	BlitOp op = {BlitOp::XRGB};
+
+	Stretch(sTex, GSVector4(0, 0, 1, 1), dTex, dRect, op);
+}
+
+void GSDeviceSW::Flip()
+{
+	GSTexture::GSMap m;
+
+	if(m_backbuffer->Map(m))
+	{
+		video_cb(m.bits, m_backbuffer->GetWidth(), m_backbuffer->GetHeight(), m.pitch);
+
+		m_backbuffer->Unmap();
+	}
+}
+
+void GSDeviceSW::ClearRenderTarget(GSTexture* t, const GSVector4& c)
+{
+	Fill(t, (c * 255 + GSVector4(0.5f)).rgba32());
+}
+
+void GSDeviceSW::ClearRenderTarget(GSTexture* t, uint32 c)
+{
+	Fill(t, c);
+}
+
+void GSDeviceSW::CopyRect(GSTexture* sTex, GSTexture* dTex, const GSVector4i& r)
+{
+	GSTexture::GSMap m;
+
+	if(sTex->Map(m, &r))
+	{
+		dTex->Update(r, m.bits, m.pitch);
+
+		sTex->Unmap();
+	}
+}
+
+void GSDeviceSW::StretchRect(GSTexture* sTex, const GSVector4& sRect, GSTexture* dTex, const GSVector4& dRect, int shader, bool linear)
+{
+	BlitOp op = {BlitOp::Copy};
+
+	Stretch(sTex, sRect, dTex, dRect, op, -1, linear);
+}
+
+void GSDeviceSW::DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c)
+{
+	// Same steps as the hw devices, minus the feedback write (sTex[2]), which needs the YUV shader.
+
+	ClearRenderTarget(dTex, c);
+
+	if(sTex[1] && PMODE.SLBG == 0)
+	{
+		BlitOp op = {BlitOp::Copy};
+
+		Stretch(sTex[1], sRect[1], dTex, dRect[1], op);
+	}
+
+	if(sTex[0])
+	{
+		BlitOp op = {BlitOp::Blend};
+
+		op.texel_alpha = PMODE.MMOD == 0;
+		op.alpha = GSVector4i((int)(c.a * 128 + 0.5f) * 0x00010001);
+		op.keep_alpha = PMODE.AMOD == 1;
+
+		Stretch(sTex[0], sRect[0], dTex, dRect[0], op);
+	}
+}
+
+void GSDeviceSW::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset)
+{
+	GSVector4 s = GSVector4(dTex->GetSize());
+
+	GSVector4 sRect(0, 0, 1, 1);
+	GSVector4 dRect(0.0f, yoffset, s.x, s.y + yoffset);
+
+	BlitOp op = {BlitOp::Copy};
+
+	switch(shader)
+	{
+		case 0: // weave, odd lines
+		case 1: // weave, even lines
+			Stretch(sTex, sRect, dTex, dRect, op, shader == 0 ? 1 : 0);
+			break;
+
+		case 2: // blend, (y - 1) + 2 * y + (y + 1)
+		{
+			GSTexture::GSMap sm, dm;
+
+			if(!sTex->Map(sm))
+				break;
+
+			if(dTex->Map(dm))
+			{
+				const int w = std::min(sTex->GetWidth(), dTex->GetWidth());
+				const int h = std::min(sTex->GetHeight(), dTex->GetHeight());
+
+				for(int y = 0; y < h; y++)
+				{
+					const GSVector4i* RESTRICT s0 = (GSVector4i*)(sm.bits + sm.pitch * std::max(y - 1, 0));
+					const GSVector4i* RESTRICT s1 = (GSVector4i*)(sm.bits + sm.pitch * y);
+					const GSVector4i* RESTRICT s2 = (GSVector4i*)(sm.bits + sm.pitch * std::min(y + 1, h - 1));
+					GSVector4i* RESTRICT d = (GSVector4i*)(dm.bits + dm.pitch * y);
+
+					// GSTextureSW rows are 32 byte aligned, so a partial last vector stays inside the row
+					for(int x = 0, n = (w + 3) >> 2; x < n; x++)
+					{
+						d[x] = s0[x].avg8(s2[x]).avg8(s1[x]);
+					}
+				}
+
+				dTex->Unmap();
+			}
+
+			sTex->Unmap();
+
+			break;
+		}
+
+		case 3: // bob
+		default:
+			Stretch(sTex, sRect, dTex, dRect, op, -1, linear);
+			break;
+	}
+}
+
+void GSDeviceSW::Fill(GSTexture* t, uint32 c)
+{
+	GSTexture::GSMap m;
+
+	if(t->Map(m))
+	{
+		GSVector4i v(c);
+
+		const int n = (t->GetWidth() + 3) >> 2;
+
+		for(int y = t->GetHeight(); y > 0; y--, m.bits += m.pitch)
+		{
+			GSVector4i* RESTRICT d = (GSVector4i*)m.bits;
+
+			for(int x = 0; x < n; x++)
+			{
+				d[x] = v;
+			}
+		}
+
+		t->Unmap();
+	}
+}
+
+static __forceinline GSVector4i ApplyBlitOp(const GSVector4i& s, const GSVector4i& d, int type, const GSVector4i& alpha, bool texel_alpha, bool keep_alpha)
+{
+	const GSVector4i mask = GSVector4i::x000000ff();
+
+	switch(type)
+	{
+		case 0: // Copy
+			return s;
+
+		case 2: // XRGB, swap red and blue and clear alpha
+			return (s & mask).sll32(16) | (s.srl32(16) & mask) | (s & mask.sll32(8));
+
+		default: // Blend, d + (s - d) * f / 128
+		{
+			GSVector4i zero = GSVector4i::zero();
+
+			GSVector4i sl = s.upl8(zero);
+			GSVector4i sh = s.uph8(zero);
+			GSVector4i dl = d.upl8(zero);
+			GSVector4i dh = d.uph8(zero);
+
+			GSVector4i fl = alpha;
+			GSVector4i fh = alpha;
+
+			if(texel_alpha)
+			{
+				GSVector4i one = GSVector4i(0x00800080);
+
+				fl = sl.wwwwlh().min_i16(one);
+				fh = sh.wwwwlh().min_i16(one);
+			}
+
+			GSVector4i r = dl.add16(sl.sub16(dl).mul16l(fl).sra16(7)).pu16(dh.add16(sh.sub16(dh).mul16l(fh).sra16(7)));
+
+			if(keep_alpha)
+			{
+				GSVector4i amask = mask.sll32(24);
+
+				r = r.andnot(amask) | (d & amask);
+			}
+
+			return r;
+		}
+	}
+}
+
+void GSDeviceSW::BlitRow(const uint32* RESTRICT src, const int* xs, bool contiguous, uint32* RESTRICT dst, int n, const BlitOp& op)
+{
+	const int type = (int)op.type;
+
+	int i = 0;
+
+	if(contiguous)
+	{
+		src += xs[0];
+
+		for(; i + 4 <= n; i += 4)
+		{
+			GSVector4i s = GSVector4i::load<false>(&src[i]);
+			GSVector4i d = GSVector4i::load<false>(&dst[i]);
+
+			GSVector4i::store<false>(&dst[i], ApplyBlitOp(s, d, type, op.alpha, op.texel_alpha, op.keep_alpha));
+		}
+
+		src -= xs[0];
+	}
+	else
+	{
+		for(; i + 4 <= n; i += 4)
+		{
+			GSVector4i s((int)src[xs[i + 0]], (int)src[xs[i + 1]], (int)src[xs[i + 2]], (int)src[xs[i + 3]]);
+			GSVector4i d = GSVector4i::load<false>(&dst[i]);
+
+			GSVector4i::store<false>(&dst[i], ApplyBlitOp(s, d, type, op.alpha, op.texel_alpha, op.keep_alpha));
+		}
+	}
+
+	if(i < n)
+	{
+		// Run the last 1-3 pixels through a temporary vector
+
+		GSVector4i s, d;
+
+		for(int j = 0; j < n - i; j++)
+		{
+			s.u32[j] = src[xs[i + j]];
+			d.u32[j] = dst[i + j];
+		}
+
+		d = ApplyBlitOp(s, d, type, op.alpha, op.texel_alpha, op.keep_alpha);
+
+		for(int j = 0; j < n - i; j++)
+		{
+			dst[i + j] = d.u32[j];
+		}
+	}
+}
+
+void GSDeviceSW::Stretch(GSTexture* sTex, const GSVector4& sRect, GSTexture* dTex, const GSVector4& dRect, const BlitOp& op, int parity, bool linear)
+{
+	const int sw = sTex->GetWidth();
+	const int sh = sTex->GetHeight();
+	const int dw = dTex->GetWidth();
+	const int dh = dTex->GetHeight();
+
+	const int left = std::max((int)(dRect.x + 0.5f), 0);
+	const int top = std::max((int)(dRect.y + 0.5f), 0);
+	const int right = std::min((int)(dRect.z + 0.5f), dw);
+	const int bottom = std::min((int)(dRect.w + 0.5f), dh);
+
+	if(left >= right || top >= bottom || dRect.z <= dRect.x || dRect.w <= dRect.y)
+		return;
+
+	const int n = right - left;
+
+	// Nearest source column of every destination pixel, shared by all the rows
+
+	const float xscale = (sRect.z - sRect.x) * sw / (dRect.z - dRect.x);
+	const float yscale = (sRect.w - sRect.y) * sh / (dRect.w - dRect.y);
+
+	std::vector<int> xs(n);
+
+	bool contiguous = true;
+
+	for(int i = 0; i < n; i++)
+	{
+		float u = sRect.x * sw + (left + i + 0.5f - dRect.x) * xscale;
+
+		xs[i] = std::max(std::min((int)u, sw - 1), 0);
+
+		contiguous = contiguous && xs[i] == xs[0] + i;
+	}
+
+	GSTexture::GSMap sm, dm;
+
+	if(!sTex->Map(sm))
+		return;
+
+	if(!dTex->Map(dm))
+	{
+		sTex->Unmap();
+		return;
+	}
+
+	BlitOp lerp = {BlitOp::Blend};
+
+	for(int y = top; y < bottom; y++)
+	{
+		if(parity >= 0 && (y & 1) != parity)
+			continue;
+
+		float v = sRect.y * sh + (y + 0.5f - dRect.y) * yscale;
+
+		uint32* dst = (uint32*)(dm.bits + dm.pitch * y) + left;
+
+		if(linear)
+		{
+			// Vertical filtering only, the horizontal scale is 1:1 for the bob and present paths
+
+			v -= 0.5f;
+
+			int y0 = (int)floor(v);
+			int f = (int)((v - y0) * 128 + 0.5f);
+
+			int y1 = std::max(std::min(y0 + 1, sh - 1), 0);
+			y0 = std::max(std::min(y0, sh - 1), 0);
+
+			BlitRow((uint32*)(sm.bits + sm.pitch * y0), xs.data(), contiguous, dst, n, op);
+
+			if(f > 0 && y1 != y0)
+			{
+				lerp.alpha = GSVector4i(f * 0x00010001);
+
+				BlitRow((uint32*)(sm.bits + sm.pitch * y1), xs.data(), contiguous, dst, n, lerp);
+			}
+		}
+		else
+		{
+			int sy = std::max(std::min((int)v, sh - 1), 0);
+
+			BlitRow((uint32*)(sm.bits + sm.pitch * sy), xs.data(), contiguous, dst, n, op);
+		}
+	}
+
+	dTex->Unmap();
+	sTex->Unmap();
+}
@@ -0,0 +1,63 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "../Common/GSDevice.h"
+#include "GSTextureSW.h"
+
+// Presents the software renderer without a GL/D3D context: every surface is
+// a GSTextureSW in system memory, merge/interlace/present run on the cpu and
+// the backbuffer is handed to the frontend as XRGB8888.
+class GSDeviceSW : public GSDevice
+{
+	struct BlitOp
+	{
+		enum {Copy, Blend, XRGB} type;
+		GSVector4i alpha;	// 16-bit blend factor (0..128), only for Blend with a constant alpha
+		bool texel_alpha;	// Blend by min(2 * source alpha, 1) instead
+		bool keep_alpha;	// Leave the destination alpha untouched
+	};
+
+	static void BlitRow(const uint32* RESTRICT src, const int* xs, bool contiguous, uint32* RESTRICT dst, int n, const BlitOp& op);
+	static void Stretch(GSTexture* sTex, const GSVector4& sRect, GSTexture* dTex, const GSVector4& dRect, const BlitOp& op, int parity = -1, bool linear = false);
+	static void Fill(GSTexture* t, uint32 c);
+
+	GSTexture* CreateSurface(int type, int w, int h, int format);
+
+	void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c);
+	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset = 0);
+	uint16 ConvertBlendEnum(uint16 generic) { return generic; }
+
+public:
+	GSDeviceSW() {}
+
+	bool Create();
+	bool Reset(int w, int h);
+	void Present(GSTexture* sTex, GSTexture* dTex, const GSVector4& dRect, int shader = 0);
+	void Flip();
+
+	void ClearRenderTarget(GSTexture* t, const GSVector4& c);
+	void ClearRenderTarget(GSTexture* t, uint32 c);
+
+	void CopyRect(GSTexture* sTex, GSTexture* dTex, const GSVector4i& r);
+	void StretchRect(GSTexture* sTex, const GSVector4& sRect, GSTexture* dTex, const GSVector4& dRect, int shader = 0, bool linear = true);
+};
@@ -128,7 +128,12 @@ int GSRasterizer::GetPixels(bool reset)
 
 void GSRasterizer::Draw(GSRasterizerData* data)
 {
-	if(data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0) return;
+	Draw(data, data->scissor, data->index, data->index_count);
+}
+
+void GSRasterizer::Draw(GSRasterizerData* data, const GSVector4i& scissor, const uint32* index, int index_count)
+{
+	if(data->vertex != NULL && data->vertex_count == 0 || index != NULL && index_count == 0) return;
 
 	m_pixels.actual = 0;
 	m_pixels.total = 0;
@@ -138,16 +143,16 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	const GSVertexSW* vertex = data->vertex;
 	const GSVertexSW* vertex_end = data->vertex + data->vertex_count;
 
-	const uint32* index = data->index;
-	const uint32* index_end = data->index + data->index_count;
+	const uint32* index_end = index + index_count;
 
 	uint32 tmp_index[] = {0, 1, 2};
 
-	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(data->scissor));
+	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(scissor));
 
-	m_scissor = data->scissor;
-	m_fscissor_x = GSVector4(data->scissor).xzxz();
-	m_fscissor_y = GSVector4(data->scissor).ywyw();
+	m_scissor = scissor;
+	m_scissor_top = data->scissor.top;
+	m_fscissor_x = GSVector4(scissor).xzxz();
+	m_fscissor_y = GSVector4(scissor).ywyw();
 
 	switch(data->primclass)
 	{
@@ -155,11 +160,11 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 		if(scissor_test)
 		{
-			DrawPoint<true>(vertex, data->vertex_count, index, data->index_count);
+			DrawPoint<true>(vertex, data->vertex_count, index, index_count);
 		}
 		else
 		{
-			DrawPoint<false>(vertex, data->vertex_count, index, data->index_count);
+			DrawPoint<false>(vertex, data->vertex_count, index, index_count);
 		}
 
 		break;
@@ -782,6 +787,8 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 
 	GSVector4i r(v[0].p.xyxy(v[1].p).ceil());
 
+	int top = std::max<int>(r.top, m_scissor_top); // first row of the whole draw, see below
+
 	r = r.rintersect(m_scissor);
 
 	if(r.rempty()) return;
@@ -833,13 +840,21 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 	dedge.t = GSVector4::zero().insert32<1, 1>(dt);
 	dscan.t = GSVector4::zero().insert32<0, 0>(dt);
 
-	GSVector4 prestep = GSVector4(r.left, r.top) - scan.p;
+	GSVector4 prestep = GSVector4(r.left, top) - scan.p;
 
 	int m = (prestep == GSVector4::zero()).mask();
 
 	if((m & 2) == 0) scan.t += dedge.t * prestep.yyyy();
 	if((m & 1) == 0) scan.t += dscan.t * prestep.xxxx();
 
+	// a bin of a binned draw steps over the rows above it like the other threads would, so
+	// that the texture coordinates don't depend on where the sprite was split
+
+	for(; top < r.top; top++)
+	{
+		scan.t += dedge.t;
+	}
+
 	m_ds->SetupPrim(vertex, index, dscan);
 
 	while(1)
@@ -1195,3 +1210,271 @@ int GSRasterizerList::GetPixels(bool reset)
 
 	return pixels;
 }
+
+//
+
+GSRasterizerBinned::GSRasterizerBinned(int threads)
+	: m_pending(0)
+	, m_exit(false)
+{
+	m_bin_height = compute_best_thread_height(threads);
+
+	int bins = 2048 >> m_bin_height;
+
+	m_bins.resize(bins);
+	m_count.resize(bins);
+
+	for(Bin& bin : m_bins)
+	{
+		bin.active = false;
+	}
+}
+
+GSRasterizerBinned::~GSRasterizerBinned()
+{
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		m_exit = true;
+	}
+
+	m_notempty.notify_all();
+
+	for(std::thread& t : m_workers)
+	{
+		t.join();
+	}
+}
+
+void GSRasterizerBinned::Start()
+{
+	for(size_t i = 0; i < m_r.size(); i++)
+	{
+		m_workers.push_back(std::thread(&GSRasterizerBinned::ThreadProc, this, (int)i));
+	}
+}
+
+void GSRasterizerBinned::ThreadProc(int id)
+{
+	GSRasterizer* r = m_r[id].get();
+
+	std::unique_lock<std::mutex> l(m_lock);
+
+	while(true)
+	{
+		while(m_ready.empty())
+		{
+			if(m_exit)
+				return;
+
+			m_notempty.wait(l);
+		}
+
+		Bin& bin = m_bins[m_ready.front()];
+
+		m_ready.pop_front();
+
+		// the bin stays active until it is drained, nobody else may draw it meanwhile
+
+		while(!bin.jobs.empty())
+		{
+			Job job = std::move(bin.jobs.front());
+
+			bin.jobs.pop_front();
+
+			l.unlock();
+
+			r->Draw(job.data.get(), job.scissor, job.index, job.index_count);
+
+			job.data.reset(); // the last reference releases the pages of the draw, don't hold the lock for that
+			job.buff.reset();
+
+			l.lock();
+
+			if(--m_pending == 0)
+			{
+				m_empty.notify_all();
+			}
+		}
+
+		bin.active = false;
+	}
+}
+
+void GSRasterizerBinned::Push(const std::shared_ptr<GSRasterizerData>& data, const std::shared_ptr<std::vector<uint32>>& buff, const uint32* index, int index_count, int bin)
+{
+	Job job;
+
+	job.data = data;
+	job.buff = buff;
+	job.index = index;
+	job.index_count = index_count;
+	job.scissor = data->scissor;
+	job.scissor.top = std::max<int>(job.scissor.top, bin << m_bin_height);
+	job.scissor.bottom = std::min<int>(job.scissor.bottom, (bin + 1) << m_bin_height);
+
+	m_bins[bin].jobs.push_back(std::move(job));
+
+	m_pending++;
+
+	if(!m_bins[bin].active)
+	{
+		m_bins[bin].active = true;
+
+		m_ready.push_back(bin);
+	}
+}
+
+void GSRasterizerBinned::Queue(const std::shared_ptr<GSRasterizerData>& data)
+{
+	if(data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0) return;
+
+	GSVector4i r = data->bbox.rintersect(data->scissor);
+
+	ASSERT(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
+
+	// antialiased edges may reach a row below the bounding box
+
+	r.bottom = std::min<int>(r.bottom + 2, std::min<int>(data->scissor.bottom, 2048));
+
+	if(r.top >= r.bottom) return;
+
+	int top = r.top >> m_bin_height;
+	int bottom = ((r.bottom - 1) >> m_bin_height) + 1;
+
+	if(bottom - top == 1)
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		Push(data, std::shared_ptr<std::vector<uint32>>(), data->index, data->index_count, top);
+
+		m_notempty.notify_one();
+
+		return;
+	}
+
+	// count the primitives of each bin, then store their indices bin after bin
+
+	static const int s_prim_size[4] = {1, 2, 3, 2};
+
+	int n = s_prim_size[data->primclass];
+	int count = (data->index != NULL ? data->index_count : data->vertex_count) / n;
+
+	const GSVertexSW* RESTRICT vertex = data->vertex;
+	const uint32* RESTRICT index = data->index;
+
+	auto bins = [&](int i, int& first, int& last)
+	{
+		float ymin = vertex[index != NULL ? index[i * n] : i * n].p.y;
+		float ymax = ymin;
+
+		for(int j = 1; j < n; j++)
+		{
+			float y = vertex[index != NULL ? index[i * n + j] : i * n + j].p.y;
+
+			ymin = std::min(ymin, y);
+			ymax = std::max(ymax, y);
+		}
+
+		// rows are picked by rounding up, truncating, or one past the edge for antialiasing
+
+		first = std::max<int>((int)floorf(ymin), r.top) >> m_bin_height;
+		last = std::min<int>((int)floorf(ymax) + 1, r.bottom - 1) >> m_bin_height;
+	};
+
+	memset(&m_count[top], 0, sizeof(int) * (bottom - top));
+
+	int total = 0;
+
+	for(int i = 0; i < count; i++)
+	{
+		int first, last;
+
+		bins(i, first, last);
+
+		for(int b = first; b <= last; b++)
+		{
+			m_count[b]++;
+		}
+
+		total += std::max<int>(last - first + 1, 0);
+	}
+
+	std::shared_ptr<std::vector<uint32>> buff = std::make_shared<std::vector<uint32>>(total * n);
+
+	std::vector<uint32*> dst(bottom - top);
+
+	uint32* p = buff->data();
+
+	for(int b = top; b < bottom; b++)
+	{
+		dst[b - top] = p;
+
+		p += m_count[b] * n;
+	}
+
+	for(int i = 0; i < count; i++)
+	{
+		int first, last;
+
+		bins(i, first, last);
+
+		for(int b = first; b <= last; b++)
+		{
+			uint32*& d = dst[b - top];
+
+			for(int j = 0; j < n; j++)
+			{
+				*d++ = index != NULL ? index[i * n + j] : i * n + j;
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		p = buff->data();
+
+		for(int b = top; b < bottom; b++)
+		{
+			if(m_count[b] > 0)
+			{
+				Push(data, buff, p, m_count[b] * n, b);
+
+				p += m_count[b] * n;
+			}
+		}
+	}
+
+	m_notempty.notify_all();
+}
+
+void GSRasterizerBinned::Sync()
+{
+	if(!IsSynced())
+	{
+		std::unique_lock<std::mutex> l(m_lock);
+
+		while(m_pending > 0)
+		{
+			m_empty.wait(l);
+		}
+	}
+}
+
+bool GSRasterizerBinned::IsSynced() const
+{
+	return m_pending == 0;
+}
+
+int GSRasterizerBinned::GetPixels(bool reset)
+{
+	int pixels = 0;
+
+	for(size_t i = 0; i < m_r.size(); i++)
+	{
+		pixels += m_r[i]->GetPixels(reset);
+	}
+
+	return pixels;
+}
@@ -26,6 +26,9 @@
 #include "../../GSAlignedClass.h"
 #include "../../GSThread_CXX11.h"
 
+#include <atomic>
+#include <deque>
+
 class alignas(32) GSRasterizerData : public GSAlignedClass<32>
 {
 	static int s_counter;
@@ -124,6 +127,7 @@ protected:
 	int m_thread_height;
 	uint8* m_scanline;
 	GSVector4i m_scissor;
+	int m_scissor_top;
 	GSVector4 m_fscissor_x;
 	GSVector4 m_fscissor_y;
 	struct {GSVertexSW* buff; int count;} m_edge;
@@ -160,6 +164,7 @@ public:
 	__forceinline int FindMyNextScanline(int top) const;
 
 	void Draw(GSRasterizerData* data);
+	void Draw(GSRasterizerData* data, const GSVector4i& scissor, const uint32* index, int index_count);
 
 	// IRasterizer
 
@@ -169,6 +174,75 @@ public:
 	int GetPixels(bool reset);
 };
 
+// Sorts the primitives of every draw into horizontal bins once, on the queuing thread, and lets
+// any idle worker take the next bin that has work.  A bin is drawn by one worker at a time and
+// in queue order, which keeps the draws in order on every pixel.  Bins are full width, so a
+// primitive split over several bins interpolates exactly like the single threaded rasterizer.
+
+class GSRasterizerBinned : public IRasterizer
+{
+protected:
+	struct Job
+	{
+		std::shared_ptr<GSRasterizerData> data;
+		std::shared_ptr<std::vector<uint32>> buff; // owns index, unless it points into data
+		const uint32* index;
+		int index_count;
+		GSVector4i scissor;
+	};
+
+	struct Bin
+	{
+		std::deque<Job> jobs;
+		bool active; // queued in m_ready or being drawn
+	};
+
+	std::vector<std::unique_ptr<GSRasterizer>> m_r;
+	std::vector<std::thread> m_workers;
+	std::vector<Bin> m_bins;
+	std::vector<int> m_count;
+	std::deque<int> m_ready;
+	std::atomic<int> m_pending;
+	bool m_exit;
+	int m_bin_height;
+
+	std::mutex m_lock;
+	std::condition_variable m_notempty;
+	std::condition_variable m_empty;
+
+	GSRasterizerBinned(int threads);
+
+	void Start();
+	void ThreadProc(int id);
+	void Push(const std::shared_ptr<GSRasterizerData>& data, const std::shared_ptr<std::vector<uint32>>& buff, const uint32* index, int index_count, int bin);
+
+public:
+	virtual ~GSRasterizerBinned();
+
+	template<class DS> static IRasterizer* Create(int threads)
+	{
+		GSRasterizerBinned* rb = new GSRasterizerBinned(threads);
+
+		for(int i = 0; i < threads; i++)
+		{
+			// every worker may draw any bin, so each one owns all the scanlines
+
+			rb->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), 0, 1)));
+		}
+
+		rb->Start();
+
+		return rb;
+	}
+
+	// IRasterizer
+
+	void Queue(const std::shared_ptr<GSRasterizerData>& data);
+	void Sync();
+	bool IsSynced() const;
+	int GetPixels(bool reset);
+};
+
 class GSRasterizerList : public IRasterizer
 {
 protected:
@@ -194,6 +268,11 @@ public:
 			return new GSRasterizer(new DS(), 0, 1);
 		}
 
+		if(theApp.GetConfigB("extrathreads_binning"))
+		{
+			return GSRasterizerBinned::Create<DS>(threads);
+		}
+
 		GSRasterizerList* rl = new GSRasterizerList(threads);
 
 		for(int i = 0; i < threads; i++)
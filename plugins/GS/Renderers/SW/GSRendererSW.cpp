@@ -395,18 +395,21 @@ void GSRendererSW::Draw()
 		zb_pages = m_context->offset.zb->GetPages(r);
 	}
 
+	// Conflicts only wait for the queued draws which use the same pages, anything else keeps
+	// running. This has to happen before this draw addrefs its own pages below.
+
 	// check if there is an overlap between this and previous targets
 
 	if(CheckTargetPages(fb_pages, zb_pages, r))
 	{
-		sd->m_syncpoint = SharedData::SyncTarget;
+		WaitTargetPages();
 	}
 
 	// check if the texture is not part of a target currently in use
 
 	if(CheckSourcePages(sd))
 	{
-		sd->m_syncpoint = SharedData::SyncSource;
+		WaitSourcePages(sd);
 	}
 
 	// addref source and target pages
@@ -424,20 +427,10 @@ void GSRendererSW::Queue(std::shared_ptr<GSRasterizerData>& item)
 {
 	SharedData* sd = (SharedData*)item.get();
 
-	if(sd->m_syncpoint == SharedData::SyncSource) 
-	{
-		Sync(4);
-	}
-
 	// update previously invalidated parts
 
 	sd->UpdateSource();
 
-	if(sd->m_syncpoint == SharedData::SyncTarget)
-	{
-		Sync(5);
-	}
-
 	m_rl->Queue(item);
 
 	// invalidate new parts rendered onto
@@ -470,18 +463,10 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 	if(!m_rl->IsSynced())
 	{
-		for(uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
-		{
-			if(m_fzb_pages[*p] | m_tex_pages[*p])
-			{
-				Sync(6);
-
-				break;
-			}
-		}
+		WaitPages(m_tmp_pages, 0xffffffff, true, 6);
 	}
 
-	m_tc->InvalidatePages(m_tmp_pages, off->psm); // if texture update runs on a thread and Sync(5) happens then this must come later
+	m_tc->InvalidatePages(m_tmp_pages, off->psm); // if texture update runs on a thread and a wait happens then this must come later
 }
 
 void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut)
@@ -492,15 +477,7 @@ void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 		off->GetPages(r, m_tmp_pages);
 
-		for(uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
-		{
-			if(m_fzb_pages[*p])
-			{
-				Sync(7);
-
-				break;
-			}
-		}
+		WaitPages(m_tmp_pages, 0xffffffff, false, 7);
 	}
 }
 
@@ -546,6 +523,52 @@ void GSRendererSW::ReleasePages(const uint32* pages, const int type)
 	}
 }
 
+void GSRendererSW::WaitPages(const uint32* pages, uint32 target, bool texture, int reason)
+{
+	// Only the gs thread adds page references, so once a page is idle it stays idle
+	// and the pages can be waited for one after the other. Spinning only pays off for
+	// draws about to finish, anything longer sleeps in Sync, which releases every page.
+	// target masks the frame (low half) and z-buffer (high half) references to wait for.
+
+	int spins = 0;
+
+	for(const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		while((m_fzb_pages[*p] & target) || (texture && m_tex_pages[*p]))
+		{
+			if(++spins > 64)
+			{
+				Sync(reason);
+
+				return;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+}
+
+void GSRendererSW::WaitTargetPages()
+{
+	// Queued draws to the same target are already ordered, every rasterizer thread owns the same
+	// scanlines of each of them. Only wait for the users CheckTargetPages found unordered: draws
+	// to other targets, texture reads, and the frame and z-buffer of this target crossing.
+
+	WaitPages(m_fzb_wait_pages[0], 0xffffffff, true, 5);
+	WaitPages(m_fzb_wait_pages[1], 0xffff0000, false, 5);
+	WaitPages(m_fzb_wait_pages[2], 0x0000ffff, false, 5);
+}
+
+void GSRendererSW::WaitSourcePages(SharedData* sd)
+{
+	for(size_t i = 0; sd->m_tex[i].t != NULL; i++)
+	{
+		sd->m_tex[i].t->m_offset->GetPages(sd->m_tex[i].r, m_tmp_pages);
+
+		WaitPages(m_tmp_pages, 0xffffffff, false, 4);
+	}
+}
+
 bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r)
 {
 	bool synced = m_rl->IsSynced();
@@ -555,6 +578,10 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 	bool res = false;
 
+	uint32* any_wait = m_fzb_wait_pages[0];
+	uint32* zb_wait = m_fzb_wait_pages[1];
+	uint32* fb_wait = m_fzb_wait_pages[2];
+
 	if(m_fzb != m_context->offset.fzb4)
 	{
 		// targets changed, check everything
@@ -578,8 +605,12 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 			m_fzb_cur_pages[row] |= col;
 
-			used |= m_fzb_pages[i];
-			used |= m_tex_pages[i];
+			if(m_fzb_pages[i] | m_tex_pages[i])
+			{
+				*any_wait++ = i;
+
+				used = 1;
+			}
 		}
 
 		for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
@@ -591,8 +622,12 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 			m_fzb_cur_pages[row] |= col;
 
-			used |= m_fzb_pages[i];
-			used |= m_tex_pages[i];
+			if(m_fzb_pages[i] | m_tex_pages[i])
+			{
+				*any_wait++ = i;
+
+				used = 1;
+			}
 		}
 
 		if(!synced)
@@ -631,7 +666,12 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 				{
 					m_fzb_cur_pages[row] |= col;
 
-					used |= m_fzb_pages[i];
+					if(m_fzb_pages[i] | m_tex_pages[i])
+					{
+						*any_wait++ = i;
+
+						used = 1;
+					}
 				}
 			}
 
@@ -646,7 +686,12 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 				{
 					m_fzb_cur_pages[row] |= col;
 
-					used |= m_fzb_pages[i];
+					if(m_fzb_pages[i] | m_tex_pages[i])
+					{
+						*any_wait++ = i;
+
+						used = 1;
+					}
 				}
 			}
 
@@ -662,33 +707,38 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 			// chross-check frame and z-buffer pages, they cannot overlap with eachother and with previous batches in queue,
 			// have to be careful when the two buffers are mutually enabled/disabled and alternating (Bully FBP/ZBP = 0x2300)
 
-			if(fb && !res)
+			if(fb)
 			{
 				for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
 				{
 					if(m_fzb_pages[*p] & 0xffff0000)
 					{
+						*zb_wait++ = *p;
+
 						res = true;
-						break;
 					}
 				}
 			}
 
-			if(zb && !res)
+			if(zb)
 			{
 				for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
 				{
 					if(m_fzb_pages[*p] & 0x0000ffff)
 					{
-						res = true;
+						*fb_wait++ = *p;
 
-						break;
+						res = true;
 					}
 				}
 			}
 		}
 	}
 
+	*any_wait = GSOffset::EOP;
+	*zb_wait = GSOffset::EOP;
+	*fb_wait = GSOffset::EOP;
+
 	if(!fb && fb_pages != NULL) delete [] fb_pages;
 	if(!zb && zb_pages != NULL) delete [] zb_pages;
 
@@ -1197,7 +1247,6 @@ GSRendererSW::SharedData::SharedData(GSRendererSW* parent)
 	, m_fpsm(0)
 	, m_zpsm(0)
 	, m_using_pages(false)
-	, m_syncpoint(SyncNone)
 {
 	m_tex[0].t = NULL;
 
@@ -47,7 +47,6 @@ class GSRendererSW : public GSRenderer
 		int m_zpsm;
 		bool m_using_pages;
 		TextureLevel m_tex[7 + 1]; // NULL terminated
-		enum {SyncNone, SyncSource, SyncTarget} m_syncpoint;
 
 	public:
 		SharedData(GSRendererSW* parent);
@@ -78,6 +77,7 @@ protected:
 	std::atomic<uint32> m_fzb_pages[512]; // uint16 frame/zbuf pages interleaved
 	std::atomic<uint16> m_tex_pages[512];
 	uint32 m_tmp_pages[512 + 1];
+	uint32 m_fzb_wait_pages[3][1024 + 1]; // conflicts found by CheckTargetPages: any user, z-buffer users, frame users
 
 	void Reset();
 	void VSync(int field);
@@ -97,6 +97,10 @@ protected:
 	bool CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r);
 	bool CheckSourcePages(SharedData* sd);
 
+	void WaitPages(const uint32* pages, uint32 target, bool texture, int reason);
+	void WaitTargetPages();
+	void WaitSourcePages(SharedData* sd);
+
 	bool GetScanlineGlobalData(SharedData* data);
 
 public: